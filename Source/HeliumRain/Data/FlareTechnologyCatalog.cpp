@@ -22,6 +22,7 @@ UFlareTechnologyCatalog::UFlareTechnologyCatalog(const class FObjectInitializer&
 		//FLOGV("UFlareTechnologyCatalog::UFlareTechnologyCatalog : Found '%s'", *AssetList[Index].GetFullName());
 		UFlareTechnologyCatalogEntry* Technology = Cast<UFlareTechnologyCatalogEntry>(AssetList[Index].GetAsset());
 		FCHECK(Technology);
+		TechnologyIndices.Add(Technology->Data.Identifier, TechnologyCatalog.Num());
 		TechnologyCatalog.Add(Technology);
 	}
 }
@@ -33,17 +34,18 @@ UFlareTechnologyCatalog::UFlareTechnologyCatalog(const class FObjectInitializer&
 
 FFlareTechnologyDescription* UFlareTechnologyCatalog::Get(FName Identifier) const
 {
-	auto FindByName = [=](const UFlareTechnologyCatalogEntry* Candidate)
+	int32 TechnologyIndex = GetTechnologyIndex(Identifier);
+	if (TechnologyIndex != INDEX_NONE && TechnologyCatalog[TechnologyIndex])
 	{
-		return Candidate->Data.Identifier == Identifier;
-	};
-
-	UFlareTechnologyCatalogEntry* const* Entry = TechnologyCatalog.FindByPredicate(FindByName);
-	if (Entry && *Entry)
-	{
-		return &((*Entry)->Data);
+		return &(TechnologyCatalog[TechnologyIndex]->Data);
 	}
 
 	return NULL;
 }
 
+int32 UFlareTechnologyCatalog::GetTechnologyIndex(FName Identifier) const
+{
+	const int32* TechnologyIndex = TechnologyIndices.Find(Identifier);
+	return TechnologyIndex ? *TechnologyIndex : INDEX_NONE;
+}
+
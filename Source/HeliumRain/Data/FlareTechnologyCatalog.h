@@ -29,5 +29,13 @@ public:
 	/** Get a ship from identifier */
 	FFlareTechnologyDescription* Get(FName Identifier) const;
 
+	/** Get the dense index of a technology, or INDEX_NONE */
+	int32 GetTechnologyIndex(FName Identifier) const;
+
+protected:
+
+	/** Dense technology indices, in catalog order */
+	TMap<FName, int32> TechnologyIndices;
+
 
 };
@@ -7,6 +7,8 @@
 #include "../Data/FlareResourceCatalog.h"
 
 #include "../Game/FlareGame.h"
+#include "../Game/FlareCompany.h"
+#include "../Game/FlareSimulatedSector.h"
 #include "../Quests/FlareQuestManager.h"
 
 #include "../Spacecrafts/FlareSimulatedSpacecraft.h"
@@ -228,6 +230,7 @@ int32 UFlareCargoBay::TakeResources(FFlareResourceDescription* Resource, int32 Q
 
 			if (QuantityToTake == 0)
 			{
+				NotifyCargoChanged(Resource, -Quantity);
 				return Quantity;
 			}
 		}
@@ -257,16 +260,19 @@ int32 UFlareCargoBay::TakeResources(FFlareResourceDescription* Resource, int32 Q
 
 				if (QuantityToTake == 0)
 				{
+					NotifyCargoChanged(Resource, -Quantity);
 					return Quantity;
 				}
 			}
 		}
 	}
+	NotifyCargoChanged(Resource, QuantityToTake - Quantity);
 	return Quantity - QuantityToTake;
 }
 
 void UFlareCargoBay::DumpCargo(FFlareCargo* Cargo)
 {
+	NotifyCargoChanged(Cargo->Resource, -Cargo->Quantity);
 	Cargo->Quantity = 0;
 	if (Cargo->Lock == EFlareResourceLock::NoLock)
 	{
@@ -304,6 +310,7 @@ int32 UFlareCargoBay::GiveResources(FFlareResourceDescription* Resource, int32 Q
 
 				if (QuantityToGive == 0)
 				{
+					NotifyCargoChanged(Resource, Quantity);
 					return Quantity;
 				}
 			}
@@ -332,6 +339,7 @@ int32 UFlareCargoBay::GiveResources(FFlareResourceDescription* Resource, int32 Q
 
 				if (QuantityToGive == 0)
 				{
+					NotifyCargoChanged(Resource, Quantity);
 					return Quantity;
 				}
 			}
@@ -343,9 +351,48 @@ int32 UFlareCargoBay::GiveResources(FFlareResourceDescription* Resource, int32 Q
 		}
 	}
 
+	NotifyCargoChanged(Resource, Quantity - QuantityToGive);
 	return Quantity - QuantityToGive;
 }
 
+void UFlareCargoBay::NotifyCargoChanged(FFlareResourceDescription* Resource, int32 Quantity)
+{
+	if (Quantity == 0 || !Resource)
+	{
+		return;
+	}
+
+	Parent->GetCompany()->InvalidateSpacecraftValue(Parent);
+	NotifySlotsChanged();
+}
+
+void UFlareCargoBay::NotifySlotsChanged()
+{
+	if (Parent->GetCurrentSector())
+	{
+		Parent->GetCurrentSector()->InvalidateResourceStock();
+	}
+
+	if (!Parent->IsStation())
+	{
+		return;
+	}
+
+	for (UFlareFactory* Factory : Parent->GetFactories())
+	{
+		Factory->WakeUp();
+	}
+
+	// Complex elements use the cargo bay of their master
+	for (UFlareSimulatedSpacecraft* Child : Parent->GetComplexChildren())
+	{
+		for (UFlareFactory* Factory : Child->GetFactories())
+		{
+			Factory->WakeUp();
+		}
+	}
+}
+
 
 /*----------------------------------------------------
 	Getters
@@ -552,6 +599,7 @@ bool UFlareCargoBay::LockSlot(FFlareResourceDescription* Resource, EFlareResourc
 		{
 			Cargo.Lock = LockType;
 			Cargo.ManualLock = ManualLock;
+			NotifySlotsChanged();
 			return true;
 		}
 	}
@@ -565,6 +613,7 @@ bool UFlareCargoBay::LockSlot(FFlareResourceDescription* Resource, EFlareResourc
 			Cargo.ManualLock = ManualLock;
 			Cargo.Resource = Resource;
 			Cargo.Quantity = 0;
+			NotifySlotsChanged();
 			return true;
 		}
 	}
@@ -606,6 +655,8 @@ void UFlareCargoBay::UnlockAll(bool IgnoreManualLock)
 			}
 		}
 	}
+
+	NotifySlotsChanged();
 }
 
 void UFlareCargoBay::SetSlotRestriction(int32 SlotIndex, EFlareResourceRestriction::Type RestrictionType)
@@ -615,6 +666,7 @@ void UFlareCargoBay::SetSlotRestriction(int32 SlotIndex, EFlareResourceRestricti
 		FLOGV("Invalid index %d for set slot restriction (cargo bay size: %d)", SlotIndex, CargoBay.Num());
 	}
 	CargoBay[SlotIndex].Restriction = RestrictionType;
+	NotifySlotsChanged();
 }
 
 bool UFlareCargoBay::WantSell(FFlareResourceDescription* Resource, UFlareCompany* Client, bool RequireStock) const
@@ -60,6 +60,12 @@ public:
 
 protected:
 
+	/** Propagate a cargo quantity change of Quantity units (negative if taken) */
+	void NotifyCargoChanged(FFlareResourceDescription* Resource, int32 Quantity);
+
+	/** Let the factories of the parent station and the sector resource stats see a slot change */
+	void NotifySlotsChanged();
+
 	/*----------------------------------------------------
 	   Protected data
 	----------------------------------------------------*/
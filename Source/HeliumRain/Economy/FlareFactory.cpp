@@ -22,6 +22,9 @@
 
 #define MAX_DAMAGE_MALUS 10
 
+// Sleeping factories are checked again after this delay even without a state change
+#define FACTORY_SLEEP_MAX_DAYS 10
+
 
 /*----------------------------------------------------
 	Constructor
@@ -40,6 +43,12 @@ void UFlareFactory::Load(UFlareSimulatedSpacecraft* ParentSpacecraft, const FFla
 	FactoryDescription = Description;
 	Parent = ParentSpacecraft;
 	CycleCostCacheLevel = -1;
+	ShipCycleData = NULL;
+	ShipCycleDataClass = NAME_None;
+	CostReservedCycleData = NULL;
+	CostReservedCacheValid = false;
+	Sleeping = false;
+	WakeDate = 0;
 
 	if (IsShipyard() && FactoryData.TargetShipClass == NAME_None && FactoryData.Active)
 	{
@@ -62,6 +71,8 @@ void UFlareFactory::Simulate()
 
 	if (!FactoryData.Active)
 	{
+		// Wait to be started
+		Sleep();
 		goto post_prod;
 	}
 
@@ -70,18 +81,20 @@ void UFlareFactory::Simulate()
 	if (!IsNeedProduction())
 	{
 		// Don't produce if not needed
+		Sleep();
 		goto post_prod;
 	}
 
 	if (HasCostReserved())
 	{
+		int64 ProductionTime = GetProductionTime(GetCycleData());
 
-		if (FactoryData.ProductedDuration < GetProductionTime(GetCycleData()))
+		if (FactoryData.ProductedDuration < ProductionTime)
 		{
 			FactoryData.ProductedDuration += 1;
 		}
 
-		if (FactoryData.ProductedDuration < GetProductionTime(GetCycleData()))
+		if (FactoryData.ProductedDuration < ProductionTime)
 		{
 
 			// Still In production
@@ -92,6 +105,7 @@ void UFlareFactory::Simulate()
 		{
 			// TODO display warning to user
 			// No free space wait.
+			Sleep();
 			goto post_prod;
 		}
 
@@ -105,6 +119,12 @@ void UFlareFactory::Simulate()
 		DoProduction();
 	}
 
+	// Wait for input resources. Missing money is polled daily, as it doesn't come from the cargo bay.
+	if (IsNeedProduction() && !HasCostReserved() && !HasInputResources())
+	{
+		Sleep();
+	}
+
 
 post_prod:
 
@@ -128,6 +148,40 @@ void UFlareFactory::TryBeginProduction()
 
 }
 
+void UFlareFactory::Sleep()
+{
+	if (Sleeping)
+	{
+		return;
+	}
+
+	Sleeping = true;
+	WakeDate = Game->GetGameWorld()->GetDate() + FACTORY_SLEEP_MAX_DAYS;
+	Game->GetGameWorld()->ScheduleFactoryWake(this, WakeDate);
+}
+
+void UFlareFactory::WakeUp()
+{
+	Sleeping = false;
+}
+
+void UFlareFactory::NotifyProductionChanged()
+{
+	WakeUp();
+
+	// Shipyard orders are estimated from the master station of a complex
+	Parent->InvalidateShipyardTimeline();
+	if (Parent->IsComplexElement())
+	{
+		Parent->GetComplexMaster()->InvalidateShipyardTimeline();
+	}
+
+	if (Parent->GetCurrentSector())
+	{
+		Parent->GetCurrentSector()->InvalidateResourceStats();
+	}
+}
+
 void UFlareFactory::UpdateDynamicState()
 {
 	if(FactoryData.TargetShipClass == NAME_None)
@@ -153,6 +207,7 @@ void UFlareFactory::Start()
 	}
 
 	FactoryData.Active = true;
+	NotifyProductionChanged();
 }
 
 void UFlareFactory::StartShipBuilding(FFlareShipyardOrderSave& Order)
@@ -172,6 +227,7 @@ void UFlareFactory::StartShipBuilding(FFlareShipyardOrderSave& Order)
 void UFlareFactory::Pause()
 {
 	FactoryData.Active = false;
+	NotifyProductionChanged();
 }
 
 void UFlareFactory::Stop()
@@ -183,11 +239,13 @@ void UFlareFactory::Stop()
 void UFlareFactory::SetInfiniteCycle(bool Mode)
 {
 	FactoryData.InfiniteCycle = Mode;
+	NotifyProductionChanged();
 }
 
 void UFlareFactory::SetCycleCount(uint32 Count)
 {
 	FactoryData.CycleCount = Count;
+	NotifyProductionChanged();
 }
 
 void UFlareFactory::SetOutputLimit(FFlareResourceDescription* Resource, uint32 MaxSlot)
@@ -210,6 +268,8 @@ void UFlareFactory::SetOutputLimit(FFlareResourceDescription* Resource, uint32 M
 		NewCargoLimit.Quantity = MaxSlot;
 		FactoryData.OutputCargoLimit.Add(NewCargoLimit);
 	}
+
+	NotifyProductionChanged();
 }
 
 void UFlareFactory::ClearOutputLimit(FFlareResourceDescription* Resource)
@@ -219,6 +279,7 @@ void UFlareFactory::ClearOutputLimit(FFlareResourceDescription* Resource)
 		if (FactoryData.OutputCargoLimit[CargoLimitIndex].ResourceIdentifier == Resource->Identifier)
 		{
 			FactoryData.OutputCargoLimit.RemoveAt(CargoLimitIndex);
+			NotifyProductionChanged();
 			return;
 		}
 	}
@@ -226,14 +287,34 @@ void UFlareFactory::ClearOutputLimit(FFlareResourceDescription* Resource)
 
 bool UFlareFactory::HasCostReserved()
 {
-	if (FactoryData.CostReserved < GetProductionCost())
+	// Resolve the cycle data first, as a level change invalidates the cache
+	const FFlareProductionData& CycleData = GetCycleData();
+
+	if (!CostReservedCacheValid || CostReservedCycleData != &CycleData)
+	{
+		CostReservedCache = ComputeCostReserved(CycleData);
+		CostReservedCycleData = &CycleData;
+		CostReservedCacheValid = true;
+	}
+
+	return CostReservedCache;
+}
+
+void UFlareFactory::InvalidateCostReserved()
+{
+	CostReservedCacheValid = false;
+}
+
+bool UFlareFactory::ComputeCostReserved(const FFlareProductionData& CycleData)
+{
+	if (FactoryData.CostReserved < GetProductionCost(&CycleData))
 	{
 		return false;
 	}
 
-	for (int32 ResourceIndex = 0 ; ResourceIndex < GetCycleData().InputResources.Num() ; ResourceIndex++)
+	for (int32 ResourceIndex = 0 ; ResourceIndex < CycleData.InputResources.Num() ; ResourceIndex++)
 	{
-		const FFlareFactoryResource* Resource = &GetCycleData().InputResources[ResourceIndex];
+		const FFlareFactoryResource* Resource = &CycleData.InputResources[ResourceIndex];
 
 		bool ResourceFound = false;
 
@@ -411,12 +492,14 @@ void UFlareFactory::BeginProduction()
 	}
 
 	FactoryData.CostReserved = GetProductionCost();
+	InvalidateCostReserved();
 }
 
 void UFlareFactory::CancelProduction()
 {
 	Parent->GetCompany()->GiveMoney(FactoryData.CostReserved, FFlareTransactionLogEntry::LogCancelFactoryWages(this));
 	FactoryData.CostReserved = 0;
+	InvalidateCostReserved();
 
 	// Restore reserved resources
 	for (int32 ReservedResourceIndex = FactoryData.ResourceReserved.Num()-1; ReservedResourceIndex >=0 ; ReservedResourceIndex--)
@@ -438,6 +521,7 @@ void UFlareFactory::CancelProduction()
 	FactoryData.ProductedDuration = 0;
 	FactoryData.TargetShipClass = NAME_None;
 	FactoryData.TargetShipCompany = NAME_None;
+	NotifyProductionChanged();
 
 	if (IsShipyard())
 	{
@@ -475,6 +559,8 @@ void UFlareFactory::DoProduction()
 			}
 		}
 	}
+	InvalidateCostReserved();
+	Parent->GetCompany()->InvalidateSpacecraftValue(Parent);
 
 	// Generate output resources
 	TArray<FFlareFactoryResource> OutputResources = GetLimitedOutputResources();
@@ -518,6 +604,7 @@ void UFlareFactory::DoProduction()
 	if (!HasInfiniteCycle())
 	{
 		FactoryData.CycleCount--;
+		NotifyProductionChanged();
 	}
 }
 
@@ -773,7 +860,12 @@ const FFlareProductionData& UFlareFactory::GetCycleData()
 {
 	if (IsShipyard() && FactoryData.TargetShipClass != NAME_None)
 	{
-		return GetCycleDataForShipClass(FactoryData.TargetShipClass);
+		if (ShipCycleDataClass != FactoryData.TargetShipClass)
+		{
+			ShipCycleData = &GetCycleDataForShipClass(FactoryData.TargetShipClass);
+			ShipCycleDataClass = FactoryData.TargetShipClass;
+		}
+		return *ShipCycleData;
 	}
 	else if (Parent->GetLevel() == CycleCostCacheLevel)
 	{
@@ -781,6 +873,7 @@ const FFlareProductionData& UFlareFactory::GetCycleData()
 	}
 	else
 	{
+		InvalidateCostReserved();
 
 		CycleCostCacheLevel = Parent->IsUnderConstruction() ? 1 : Parent->GetLevel();
 		CycleCostCache.ProductionTime = FactoryDescription->CycleCost.ProductionTime;
@@ -33,6 +33,15 @@ public:
 
 	void TryBeginProduction();
 
+	/** Stop simulating the factory until its state changes, or until the fallback check date */
+	void Sleep();
+
+	/** Simulate the factory again, after a state change */
+	void WakeUp();
+
+	/** Propagate an order or production state change to the sleep state and the sector stats */
+	void NotifyProductionChanged();
+
 	void UpdateDynamicState();
 
 	void Start();
@@ -61,6 +70,9 @@ public:
 
 	bool HasCostReserved();
 
+	/** Mark the cached reservation state as outdated, after reserved cost, resources or cycle data change */
+	void InvalidateCostReserved();
+
 	void BeginProduction();
 
 	void CancelProduction();
@@ -83,6 +95,9 @@ public:
 
 protected:
 
+	/** Check the reserved cost and resources against a production cycle */
+	bool ComputeCostReserved(const FFlareProductionData& CycleData);
+
 	/*----------------------------------------------------
 	   Protected data
 	----------------------------------------------------*/
@@ -99,6 +114,13 @@ protected:
 	uint32                                   ScaledProductionCost;
 	FFlareProductionData CycleCostCache;
 	int32 CycleCostCacheLevel;
+	const FFlareProductionData*              ShipCycleData;
+	FName                                    ShipCycleDataClass;
+	const FFlareProductionData*              CostReservedCycleData;
+	bool                                     CostReservedCacheValid;
+	bool                                     CostReservedCache;
+	bool                                     Sleeping;
+	int64                                    WakeDate;
 
 public:
 
@@ -168,6 +190,17 @@ public:
 		return FactoryData.Active;
 	}
 
+	/** Is the factory waiting for a cargo or order change */
+	inline bool IsSleeping() const
+	{
+		return Sleeping;
+	}
+
+	inline int64 GetWakeDate() const
+	{
+		return WakeDate;
+	}
+
 	inline bool IsPaused()
 	{
 		return !FactoryData.Active && FactoryData.ProductedDuration > 0;
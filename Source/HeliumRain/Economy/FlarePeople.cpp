@@ -7,6 +7,7 @@
 #include "../Game/FlareWorld.h"
 #include "../Game/FlareGame.h"
 #include "../Game/FlareSimulatedSector.h"
+#include "../Game/FlareCompany.h"
 
 #include "../Spacecrafts/FlareSimulatedSpacecraft.h"
 
@@ -42,6 +43,13 @@ void UFlarePeople::Load(UFlareSimulatedSector* ParentSector, const FFlarePeopleS
 
 	PeopleData = Data;
 	Parent = ParentSector;
+	ConsumerMarketValid = false;
+	CompanyReputationIndices.Empty();
+
+	FoodResource = Game->GetResourceCatalog()->Get("food");
+	FuelResource = Game->GetResourceCatalog()->Get("fuel");
+	ToolResource = Game->GetResourceCatalog()->Get("tools");
+	TechResource = Game->GetResourceCatalog()->Get("tech");
 }
 
 FFlarePeopleSave* UFlarePeople::Save()
@@ -177,15 +185,18 @@ void UFlarePeople::Simulate()
 
 void UFlarePeople::SimulateResourcePurchase()
 {
-	FFlareResourceDescription* Food = Game->GetResourceCatalog()->Get("food");
-	FFlareResourceDescription* Fuel = Game->GetResourceCatalog()->Get("fuel");
-	FFlareResourceDescription* Tool = Game->GetResourceCatalog()->Get("tools");
-	FFlareResourceDescription* Tech = Game->GetResourceCatalog()->Get("tech");
+	FFlareResourceDescription* Food = FoodResource;
+	FFlareResourceDescription* Fuel = FuelResource;
+	FFlareResourceDescription* Tool = ToolResource;
+	FFlareResourceDescription* Tech = TechResource;
 
 	bool LockNext = false;
 
+	// Sellers are paid once for all the purchases of the day
+	CompanyPaymentBatch Payments;
+
 	uint32 FoodConsumption = GetRessourceConsumption(Food, true);
-	uint32 BoughtFood = BuyResourcesInSector(Food, FoodConsumption, 0.001); // In Tons
+	uint32 BoughtFood = BuyResourcesInSector(Food, FoodConsumption, 0.001, Payments); // In Tons
 	//if(BoughtFood)
 	//	FLOGV("People in %s bought %u food", *Parent->GetSectorName().ToString(), BoughtFood);
 	PeopleData.FoodStock += BoughtFood * 1000; // In kg
@@ -213,7 +224,7 @@ void UFlarePeople::SimulateResourcePurchase()
 	{
 
 		uint32 FuelConsumption = GetRessourceConsumption(Fuel, true);
-		uint32 BoughtFuel = BuyResourcesInSector(Fuel, FuelConsumption, 0.002); // In Tons
+		uint32 BoughtFuel = BuyResourcesInSector(Fuel, FuelConsumption, 0.002, Payments); // In Tons
 		//if(BoughtFuel)
 		//	FLOGV("People in %s bought %u fuel", *Parent->GetSectorName().ToString(), BoughtFuel);
 		PeopleData.FuelStock += BoughtFuel * 1000; // In kg
@@ -239,7 +250,7 @@ void UFlarePeople::SimulateResourcePurchase()
 	if(!LockNext && ToolPriceRatio < 0.5)
 	{
 		uint32 ToolConsumption = GetRessourceConsumption(Tool, true);
-		uint32 BoughtTool = BuyResourcesInSector(Tool, ToolConsumption, 0.004); // In Tons
+		uint32 BoughtTool = BuyResourcesInSector(Tool, ToolConsumption, 0.004, Payments); // In Tons
 		//if(BoughtTool)
 		//	FLOGV("People in %s bought %u tool", *Parent->GetSectorName().ToString(), BoughtTool);
 		PeopleData.ToolStock += BoughtTool * 1000; // In kg
@@ -263,7 +274,7 @@ void UFlarePeople::SimulateResourcePurchase()
 	if(!LockNext)
 	{
 		uint32 TechConsumption = GetRessourceConsumption(Tech, true);
-		uint32 BoughtTech = BuyResourcesInSector(Tech, TechConsumption, 0.006); // In Tons
+		uint32 BoughtTech = BuyResourcesInSector(Tech, TechConsumption, 0.006, Payments); // In Tons
 		//if(BoughtTech)
 		//	FLOGV("People in %s bought %u tech", *Parent->GetSectorName().ToString(), BoughtTech);
 		PeopleData.TechStock += BoughtTech * 1000; // In kg
@@ -282,6 +293,8 @@ void UFlarePeople::SimulateResourcePurchase()
 		}
 	}
 
+	Payments.Apply();
+
 	// TODO use setter to set consumption
 	if (PeopleData.FoodConsumption < FOOD_MIN_CONSUMPTION)
 	{
@@ -301,23 +314,18 @@ void UFlarePeople::SimulateResourcePurchase()
 	}
 }
 
-uint32 UFlarePeople::BuyResourcesInSector(FFlareResourceDescription* Resource, uint32 Quantity, float MarketingRatio)
+uint32 UFlarePeople::BuyResourcesInSector(FFlareResourceDescription* Resource, uint32 Quantity, float MarketingRatio, CompanyPaymentBatch& Payments)
 {
 	// Find companies selling the ressource
-
-	TArray<UFlareSimulatedSpacecraft*> SellingStations;
-	TArray<UFlareCompany*> SellingCompanies;
-
-	for (int32 SpacecraftIndex = 0; SpacecraftIndex < Parent->GetSectorStations().Num(); SpacecraftIndex++)
+	if (!ConsumerMarketValid)
 	{
-		UFlareSimulatedSpacecraft* Station = Parent->GetSectorStations()[SpacecraftIndex];
+		UpdateConsumerMarket();
+	}
 
-		if(!Station->HasCapability(EFlareSpacecraftCapability::Consumer))
-		{
-			continue;
-		}
-		SellingStations.Add(Station);
-		SellingCompanies.AddUnique(Station->GetCompany());
+	TArray<PeopleConsumerMarketCompany*> SellingCompanies;
+	for (PeopleConsumerMarketCompany& MarketCompany : ConsumerMarket)
+	{
+		SellingCompanies.Add(&MarketCompany);
 	}
 
 	// Limit quantity to buy with money
@@ -350,19 +358,20 @@ uint32 UFlarePeople::BuyResourcesInSector(FFlareResourceDescription* Resource, u
 		// Compute company reputation sum to share market part
 		for (int32 CompanyIndex = 0; CompanyIndex < SellingCompanies.Num(); CompanyIndex++)
 		{
-			FFlareCompanyReputationSave* Reputation = GetCompanyReputation(SellingCompanies[CompanyIndex]);
+			FFlareCompanyReputationSave* Reputation = GetCompanyReputation(SellingCompanies[CompanyIndex]->Company);
 
 			ReputationSum += Reputation->Reputation;
 		}
 
 		for (int32 CompanyIndex = SellingCompanies.Num()-1; CompanyIndex >= 0; CompanyIndex--)
 		{
-			FFlareCompanyReputationSave* Reputation = GetCompanyReputation(SellingCompanies[CompanyIndex]);
+			PeopleConsumerMarketCompany* MarketCompany = SellingCompanies[CompanyIndex];
+			FFlareCompanyReputationSave* Reputation = GetCompanyReputation(MarketCompany->Company);
 
 			uint32 PartToBuy = FMath::CeilToInt((InitialResourceToBuy * Reputation->Reputation) / (float) ReputationSum);
 			PartToBuy = FMath::Min(ResourceToBuy, PartToBuy);
 
-			uint32 BoughtQuantity = BuyInStationForCompany(Resource, PartToBuy, SellingCompanies[CompanyIndex], SellingStations, MarketPrice);
+			uint32 BoughtQuantity = BuyInStationForCompany(Resource, PartToBuy, MarketCompany->Company, MarketCompany->Stations, MarketPrice, Payments);
 			ResourceToBuy -= BoughtQuantity;
 
 			if(PartToBuy == 0 || BoughtQuantity < PartToBuy)
@@ -375,63 +384,106 @@ uint32 UFlarePeople::BuyResourcesInSector(FFlareResourceDescription* Resource, u
 	return BaseQuantity - ResourceToBuy;
 }
 
-uint32 UFlarePeople::BuyInStationForCompany(FFlareResourceDescription* Resource, uint32 Quantity, UFlareCompany* Company, TArray<UFlareSimulatedSpacecraft*>& Stations, int64 ResourcePrice)
+uint32 UFlarePeople::BuyInStationForCompany(FFlareResourceDescription* Resource, uint32 Quantity, UFlareCompany* Company, const TArray<UFlareSimulatedSpacecraft*>& Stations, int64 ResourcePrice, CompanyPaymentBatch& Payments)
 {
 	uint32 RemainingQuantity = Quantity;
 
+	// Rank stations by fill ratio once : buying in a station empties it unless the purchase is complete
+	struct StationFillRatio
+	{
+		UFlareSimulatedSpacecraft* Station;
+		float FullRatio;
+	};
+
+	TArray<StationFillRatio> RankedStations;
+	RankedStations.Reserve(Stations.Num());
 
-	while(RemainingQuantity > 0)
+	for (UFlareSimulatedSpacecraft* Station : Stations)
 	{
-		// Always buy in the station with the highter fill ratio
-		UFlareSimulatedSpacecraft* BestStation = NULL;
-		float BestStationFullRatio = 0;
+		uint32 StationFreeSpace = Station->GetActiveCargoBay()->GetFreeSpaceForResource(Resource, Company);
+		uint32 StationResourceQuantity = Station->GetActiveCargoBay()->GetResourceQuantity(Resource, Company);
 
-		for (UFlareSimulatedSpacecraft* Station : Stations)
+		if (StationResourceQuantity == 0)
 		{
-			if(Station->GetCompany() != Company)
-			{
-				continue;
-			}
-
-			uint32 StationFreeSpace = Station->GetActiveCargoBay()->GetFreeSpaceForResource(Resource, Company);
-			uint32 StationResourceQuantity = Station->GetActiveCargoBay()->GetResourceQuantity(Resource, Company);
+			continue;
+		}
 
-			if (StationFreeSpace == 0 && StationResourceQuantity == 0)
-			{
-				continue;
-			}
+		float FullRatio =  (float) StationResourceQuantity / (float) (StationResourceQuantity + StationFreeSpace);
+		RankedStations.Add({Station, FullRatio});
+	}
 
-			float FullRatio =  (float) StationResourceQuantity / (float) (StationResourceQuantity + StationFreeSpace);
+	// Always buy in the station with the highter fill ratio, the first one on ties
+	RankedStations.StableSort([](const StationFillRatio& A, const StationFillRatio& B)
+	{
+		return A.FullRatio > B.FullRatio;
+	});
 
-			if(FullRatio > BestStationFullRatio)
-			{
-				BestStation = Station;
-				BestStationFullRatio = FullRatio;
-			}
+	for (const StationFillRatio& Ranked : RankedStations)
+	{
+		if (RemainingQuantity == 0)
+		{
+			break;
 		}
 
-		if(!BestStation)
+		uint32 TakenQuantity = Ranked.Station->GetActiveCargoBay()->TakeResources(Resource, RemainingQuantity, Company);
+		if (TakenQuantity == 0)
 		{
-			break;
+			// Cargo bay shared with a station already emptied
+			continue;
 		}
 
-		uint32 TakenQuantity = BestStation->GetActiveCargoBay()->TakeResources(Resource, RemainingQuantity, Company);
 		RemainingQuantity -= TakenQuantity;
 		uint32 Price = (uint32) (ResourcePrice) * TakenQuantity;
 		PeopleData.Money -= Price;
-		Company->GiveMoney(Price, FFlareTransactionLogEntry::LogPeoplePurchase(BestStation, Resource, TakenQuantity));
-
+		Payments.Add(Company, Price, FFlareTransactionLogEntry::LogPeoplePurchase(Ranked.Station, Resource, TakenQuantity));
 	}
 
 	return Quantity - RemainingQuantity;
 }
 
+void UFlarePeople::InvalidateConsumerMarket()
+{
+	ConsumerMarketValid = false;
+}
+
+void UFlarePeople::UpdateConsumerMarket()
+{
+	ConsumerMarket.Empty();
+	BasePopulation = 0;
+
+	for (UFlareSimulatedSpacecraft* Station : Parent->GetSectorStations())
+	{
+		if (!Station->HasCapability(EFlareSpacecraftCapability::Consumer))
+		{
+			BasePopulation += 100 * Station->GetLevel();
+			continue;
+		}
+
+		BasePopulation += 1000 * Station->GetLevel();
+
+		PeopleConsumerMarketCompany* MarketCompany = ConsumerMarket.FindByPredicate([Station](const PeopleConsumerMarketCompany& Candidate)
+		{
+			return Candidate.Company == Station->GetCompany();
+		});
+
+		if (!MarketCompany)
+		{
+			MarketCompany = &ConsumerMarket[ConsumerMarket.AddDefaulted()];
+			MarketCompany->Company = Station->GetCompany();
+		}
+
+		MarketCompany->Stations.Add(Station);
+	}
+
+	ConsumerMarketValid = true;
+}
+
 float UFlarePeople::GetRessourceConsumption(FFlareResourceDescription* Resource, bool WithStock)
 {
-	FFlareResourceDescription* Food = Game->GetResourceCatalog()->Get("food");
-	FFlareResourceDescription* Fuel = Game->GetResourceCatalog()->Get("fuel");
-	FFlareResourceDescription* Tools = Game->GetResourceCatalog()->Get("tools");
-	FFlareResourceDescription* Tech = Game->GetResourceCatalog()->Get("tech");
+	FFlareResourceDescription* Food = FoodResource;
+	FFlareResourceDescription* Fuel = FuelResource;
+	FFlareResourceDescription* Tools = ToolResource;
+	FFlareResourceDescription* Tech = TechResource;
 
 	if (PeopleData.Population == 0)
 	{
@@ -546,26 +598,22 @@ void UFlarePeople::GiveBirth(uint32 BirthCount)
 
 int32 UFlarePeople::GetBasePopulation()
 {
-	int32 BasePopulation = 0;
-
-	for (int32 SpacecraftIndex = 0; SpacecraftIndex < Parent->GetSectorStations().Num(); SpacecraftIndex++)
+	// Computed with the consumer market, from the same stations
+	if (!ConsumerMarketValid)
 	{
-		UFlareSimulatedSpacecraft* Station = Parent->GetSectorStations()[SpacecraftIndex];
-
-		if(Station->HasCapability(EFlareSpacecraftCapability::Consumer))
-		{
-			BasePopulation += 1000 * Station->GetLevel();
-		}
-		else
-		{
-			BasePopulation += 100 * Station->GetLevel();
-		}
+		UpdateConsumerMarket();
 	}
+
 	return BasePopulation;
 }
 
 void UFlarePeople::KillPeople(uint32 KillCount)
 {
+	if (KillCount == 0)
+	{
+		return;
+	}
+
 	// Never kill people below the base population
 
 	int32 PeopleToKill = FMath::Min((int32) KillCount, (int32)PeopleData.Population - GetBasePopulation());
@@ -810,10 +858,17 @@ float UFlarePeople::GetWealth()
 
 FFlareCompanyReputationSave* UFlarePeople::GetCompanyReputation(UFlareCompany* Company)
 {
+	int32* CachedIndex = CompanyReputationIndices.Find(Company);
+	if (CachedIndex)
+	{
+		return &PeopleData.CompanyReputations[*CachedIndex];
+	}
+
 	for(int ReputationIndex = 0; ReputationIndex < PeopleData.CompanyReputations.Num(); ReputationIndex++)
 	{
 		if(PeopleData.CompanyReputations[ReputationIndex].CompanyIdentifier == Company->GetIdentifier())
 		{
+			CompanyReputationIndices.Add(Company, ReputationIndex);
 			return &PeopleData.CompanyReputations[ReputationIndex];
 		}
 	}
@@ -822,9 +877,10 @@ FFlareCompanyReputationSave* UFlarePeople::GetCompanyReputation(UFlareCompany* C
 	FFlareCompanyReputationSave NewReputation;
 	NewReputation.CompanyIdentifier = Company->GetIdentifier();
 	NewReputation.Reputation = 1000 * PeopleData.Population;
-	PeopleData.CompanyReputations.Add(NewReputation);
+	int32 NewIndex = PeopleData.CompanyReputations.Add(NewReputation);
+	CompanyReputationIndices.Add(Company, NewIndex);
 
-	return GetCompanyReputation(Company);
+	return &PeopleData.CompanyReputations[NewIndex];
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -4,9 +4,11 @@
 #include "FlarePeople.generated.h"
 
 class AFlareGame;
+class UFlareCompany;
 class UFlareSimulatedSector;
 class UFlareSimulatedSpacecraft;
 struct FFlareResourceDescription;
+struct CompanyPaymentBatch;
 
 /** Sector people save data */
 USTRUCT()
@@ -80,6 +82,14 @@ struct FFlarePeopleSave
 };
 
 
+/** Consumer stations of a company in the sector */
+struct PeopleConsumerMarketCompany
+{
+	UFlareCompany* Company;
+
+	TArray<UFlareSimulatedSpacecraft*> Stations;
+};
+
 
 UCLASS()
 class HELIUMRAIN_API UFlarePeople : public UObject
@@ -105,9 +115,14 @@ public:
 
 	void SimulateResourcePurchase();
 
-	uint32 BuyResourcesInSector(FFlareResourceDescription* Resource, uint32 Quantity, float MarketingRatio);
+	/** Buy a resource from the sector companies, queuing their payments */
+	uint32 BuyResourcesInSector(FFlareResourceDescription* Resource, uint32 Quantity, float MarketingRatio, CompanyPaymentBatch& Payments);
+
+	/** Buy in the stations of a company, fullest first */
+	uint32 BuyInStationForCompany(FFlareResourceDescription* Resource, uint32 Quantity, UFlareCompany* Company, const TArray<UFlareSimulatedSpacecraft*>& Stations, int64 ResourcePrice, CompanyPaymentBatch& Payments);
 
-	uint32 BuyInStationForCompany(FFlareResourceDescription* Resource, uint32 Quantity, UFlareCompany* Company, TArray<UFlareSimulatedSpacecraft*>& Stations, int64 ResourcePrice);
+	/** Mark the consumer market as outdated, after a station is added, removed, built or upgraded */
+	void InvalidateConsumerMarket();
 
 	float GetRessourceConsumption(FFlareResourceDescription* Resource, bool WithStock);
 
@@ -137,6 +152,9 @@ public:
 
 protected:
 
+	/** Group the consumer stations of the sector by company, and compute the base population */
+	void UpdateConsumerMarket();
+
 	/*----------------------------------------------------
 	   Protected data
 	----------------------------------------------------*/
@@ -147,6 +165,20 @@ protected:
 	AFlareGame*                              Game;
 	UFlareSimulatedSector*   				 Parent;
 
+	/** Consumer stations by company, in sector order */
+	TArray<PeopleConsumerMarketCompany>      ConsumerMarket;
+	int32                                    BasePopulation;
+	bool                                     ConsumerMarketValid;
+
+	/** Consumed resources, resolved once from the catalog */
+	FFlareResourceDescription*               FoodResource;
+	FFlareResourceDescription*               FuelResource;
+	FFlareResourceDescription*               ToolResource;
+	FFlareResourceDescription*               TechResource;
+
+	/** Index of each company in the reputation save array */
+	TMap<UFlareCompany*, int32>              CompanyReputationIndices;
+
 public:
 
 	/*----------------------------------------------------
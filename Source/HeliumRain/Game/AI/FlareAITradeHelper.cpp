@@ -1383,10 +1383,13 @@ SectorVariation AITradeHelper::ComputeSectorResourceVariation(UFlareCompany* Com
 
 
 
-			SectorHelper::GetRefillFleetSupplyNeeds(Sector, OtherCompany, NeededFS, TotalNeededFS, MaxDuration, true);
+			SectorHelper::FlareFleetSupplyPlan SupplyPlan;
+			SectorHelper::ComputeFleetSupplyPlan(Sector, OtherCompany, true, SupplyPlan);
+
+			SectorHelper::GetRefillFleetSupplyNeeds(SupplyPlan, NeededFS, TotalNeededFS, MaxDuration);
 			NeededFSSum += TotalNeededFS;
 
-			SectorHelper::GetRepairFleetSupplyNeeds(Sector, OtherCompany, NeededFS, TotalNeededFS, MaxDuration, true);
+			SectorHelper::GetRepairFleetSupplyNeeds(SupplyPlan, NeededFS, TotalNeededFS, MaxDuration);
 			NeededFSSum += TotalNeededFS;
 
 			if(Company->IsPlayerCompany() && OtherCompany->IsPlayerCompany())
@@ -1498,8 +1501,11 @@ void AITradeHelper::GenerateTradingNeeds(AITradeNeeds& Needs, AITradeNeeds& Main
 			int32 RefillTotalNeededFleetSupply = 0;
 			int64 MaxDuration = 0;
 
-			SectorHelper::GetRepairFleetSupplyNeeds(Sector, Company, CurrentNeededFleetSupply, RepairTotalNeededFleetSupply, MaxDuration, true);
-			SectorHelper::GetRefillFleetSupplyNeeds(Sector, Company, CurrentNeededFleetSupply, RefillTotalNeededFleetSupply, MaxDuration, true);
+			SectorHelper::FlareFleetSupplyPlan SupplyPlan;
+			SectorHelper::ComputeFleetSupplyPlan(Sector, Company, true, SupplyPlan);
+
+			SectorHelper::GetRepairFleetSupplyNeeds(SupplyPlan, CurrentNeededFleetSupply, RepairTotalNeededFleetSupply, MaxDuration);
+			SectorHelper::GetRefillFleetSupplyNeeds(SupplyPlan, CurrentNeededFleetSupply, RefillTotalNeededFleetSupply, MaxDuration);
 
 			int32 TotalNeededFleetSupply = RepairTotalNeededFleetSupply + RefillTotalNeededFleetSupply;
 
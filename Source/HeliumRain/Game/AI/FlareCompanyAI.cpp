@@ -4,6 +4,7 @@
 #include "FlareAIBehavior.h"
 #include "FlareAITradeHelper.h"
 
+#include "../FlareBattle.h"
 #include "../FlareGame.h"
 #include "../FlareGameTools.h"
 #include "../FlareCompany.h"
@@ -25,9 +26,20 @@
 #include "../../Quests/FlareQuestGenerator.h"
 
 #include "../../Spacecrafts/FlareSimulatedSpacecraft.h"
+#include "../../Spacecrafts/Subsystems/FlareSimulatedSpacecraftDamageSystem.h"
 
 #define AI_DEBUG_AUTOSCRAP 0
 
+// Reduced searches when over the AI time budget : known sectors scanned for station construction,
+// war targets considered for an attack and battle prediction trials
+#define AI_DEGRADED_STATION_SECTOR_COUNT 5
+#define AI_DEGRADED_WAR_TARGET_COUNT 3
+#define AI_DEGRADED_BATTLE_PREDICTION_TRIALS 4
+
+// Battle prediction trials run before an attack, and the win probability needed to attack
+#define AI_BATTLE_PREDICTION_TRIALS 16
+#define AI_BATTLE_MIN_WIN_PROBABILITY 0.5f
+
 #define STATION_CONSTRUCTION_PRICE_BONUS 1.2
 
 // TODO, make it depend on company's nature
@@ -59,6 +71,7 @@
 #define LOCTEXT_NAMESPACE "FlareCompanyAI"
 
 
+DECLARE_CYCLE_STAT(TEXT("FlareCompanyAI Simulate"), STAT_FlareCompanyAI_Simulate, STATGROUP_Flare);
 DECLARE_CYCLE_STAT(TEXT("FlareCompanyAI UpdateDiplomacy"), STAT_FlareCompanyAI_UpdateDiplomacy, STATGROUP_Flare);
 
 DECLARE_CYCLE_STAT(TEXT("FlareCompanyAI UpdateTrading"), STAT_FlareCompanyAI_UpdateTrading, STATGROUP_Flare);
@@ -67,7 +80,33 @@ DECLARE_CYCLE_STAT(TEXT("FlareCompanyAI UpdateTrading Ships"), STAT_FlareCompany
 DECLARE_CYCLE_STAT(TEXT("FlareCompanyAI CargosEvasion"), STAT_FlareCompanyAI_CargosEvasion, STATGROUP_Flare);
 DECLARE_CYCLE_STAT(TEXT("FlareCompanyAI RepairAndRefill"), STAT_FlareCompanyAI_RepairAndRefill, STATGROUP_Flare);
 DECLARE_CYCLE_STAT(TEXT("FlareCompanyAI ProcessBudget"), STAT_FlareCompanyAI_ProcessBudget, STATGROUP_Flare);
+DECLARE_CYCLE_STAT(TEXT("FlareCompanyAI ProcessBudgetMilitary"), STAT_FlareCompanyAI_ProcessBudgetMilitary, STATGROUP_Flare);
+DECLARE_CYCLE_STAT(TEXT("FlareCompanyAI ProcessBudgetTrade"), STAT_FlareCompanyAI_ProcessBudgetTrade, STATGROUP_Flare);
+DECLARE_CYCLE_STAT(TEXT("FlareCompanyAI ProcessBudgetStation"), STAT_FlareCompanyAI_ProcessBudgetStation, STATGROUP_Flare);
+DECLARE_CYCLE_STAT(TEXT("FlareCompanyAI ProcessBudgetStation Scoring"), STAT_FlareCompanyAI_ProcessBudgetStation_Scoring, STATGROUP_Flare);
 DECLARE_CYCLE_STAT(TEXT("FlareCompanyAI UpdateMilitaryMovement"), STAT_FlareCompanyAI_UpdateMilitaryMovement, STATGROUP_Flare);
+DECLARE_CYCLE_STAT(TEXT("FlareCompanyAI UpdateWarMilitaryMovement"), STAT_FlareCompanyAI_UpdateWarMilitaryMovement, STATGROUP_Flare);
+
+
+/** Accumulate the duration of a scope into a company AI phase */
+struct AIPhaseTimer
+{
+	AIPhaseTimer(UFlareCompanyAI* InAI, EFlareAIPhase::Type InPhase)
+		: AI(InAI)
+		, Phase(InPhase)
+		, StartTime(FPlatformTime::Seconds())
+	{
+	}
+
+	~AIPhaseTimer()
+	{
+		AI->AddPhaseTime(Phase, FPlatformTime::Seconds() - StartTime);
+	}
+
+	UFlareCompanyAI* AI;
+	EFlareAIPhase::Type Phase;
+	double StartTime;
+};
 
 
 /*----------------------------------------------------
@@ -76,6 +115,8 @@ DECLARE_CYCLE_STAT(TEXT("FlareCompanyAI UpdateMilitaryMovement"), STAT_FlareComp
 
 UFlareCompanyAI::UFlareCompanyAI(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
+	, DayStartTime(0)
+	, SortedShipCandidatesValid(false)
 {
 	AllBudgets.Add(EFlareBudget::Military);
 	AllBudgets.Add(EFlareBudget::Station);
@@ -88,6 +129,10 @@ void UFlareCompanyAI::Load(UFlareCompany* ParentCompany, const FFlareCompanyAISa
 	Company = ParentCompany;
 	Game = Company->GetGame();
 	AIData = Data;
+	DailyWarContext = AIWarContext();
+	FleetStats = AIFleetStats();
+	BestShipChoices[0] = AIShipChoice();
+	BestShipChoices[1] = AIShipChoice();
 
 	// Setup Behavior
 	Behavior = NewObject<UFlareAIBehavior>(this, UFlareAIBehavior::StaticClass());
@@ -109,28 +154,20 @@ void UFlareCompanyAI::Simulate()
 {
 	if (Game && Company != Game->GetPC()->GetCompany())
 	{
-		AutoScrap();
+		SCOPE_CYCLE_COUNTER(STAT_FlareCompanyAI_Simulate);
+		DayStartTime = FPlatformTime::Seconds();
+		AIPhaseTimer Timer(this, EFlareAIPhase::Simulate);
 
+		AutoScrap();
+		UpdateFleetStats();
 
 		Behavior->Load(Company);
 
 		CheckBattleResolution();
 		UpdateDiplomacy();
 
-		WorldStats = WorldHelper::ComputeWorldResourceStats(Game, true);
 		Shipyards = FindShipyards();
 
-		// Compute input and output ressource equation (ex: 100 + 10/ day)
-		// TODO
-		WorldResourceVariation.Empty();
-		for (int32 SectorIndex = 0; SectorIndex < Company->GetKnownSectors().Num(); SectorIndex++)
-		{
-			UFlareSimulatedSector* Sector = Company->GetKnownSectors()[SectorIndex];
-			SectorVariation Variation = AITradeHelper::ComputeSectorResourceVariation(Company, Sector, true);
-
-			WorldResourceVariation.Add(Sector, Variation);
-			//DumpSectorResourceVariation(Sector, &Variation);
-		}
 		Behavior->Simulate();
 
 		PurchaseResearch();
@@ -150,13 +187,7 @@ void UFlareCompanyAI::Simulate()
 			AIData.Pacifism += Behavior->PacifismIncrementRate/3;
 		}
 
-		for(UFlareSimulatedSpacecraft* Spacecraft : Company->GetCompanySpacecrafts())
-		{
-			if(Spacecraft->GetDamageSystem()->GetGlobalDamageRatio() < 0.99)
-			{
-				AIData.Pacifism+= Behavior->PacifismIncrementRate * 0.5;
-			}
-		}
+		AIData.Pacifism += Behavior->PacifismIncrementRate * 0.5 * FleetStats.DamagedSpacecraftCount;
 
 		AIData.Pacifism = FMath::Clamp(AIData.Pacifism, 0.f,100.f);
 #if 0
@@ -370,6 +401,7 @@ void UFlareCompanyAI::UpdateIdleShipsStats(AITradeIdleShips& IdleShips)
 void UFlareCompanyAI::UpdateDiplomacy()
 {
 	SCOPE_CYCLE_COUNTER(STAT_FlareCompanyAI_UpdateDiplomacy);
+	AIPhaseTimer Timer(this, EFlareAIPhase::UpdateDiplomacy);
 
 	Behavior->Load(Company);
 	Behavior->UpdateDiplomacy();
@@ -378,17 +410,23 @@ void UFlareCompanyAI::UpdateDiplomacy()
 void UFlareCompanyAI::RepairAndRefill()
 {
 	SCOPE_CYCLE_COUNTER(STAT_FlareCompanyAI_RepairAndRefill);
+	AIPhaseTimer Timer(this, EFlareAIPhase::RepairAndRefill);
+
+	// Repairs don't change the refill needs, so each sector plan serves both passes
+	TArray<SectorHelper::FlareFleetSupplyPlan> SupplyPlans;
+	SupplyPlans.SetNum(Company->GetKnownSectors().Num());
 
 	for (int32 SectorIndex = 0; SectorIndex < Company->GetKnownSectors().Num(); SectorIndex++)
 	{
 		UFlareSimulatedSector* Sector = Company->GetKnownSectors()[SectorIndex];
-		SectorHelper::RepairFleets(Sector, Company);
+		SectorHelper::ComputeFleetSupplyPlan(Sector, Company, true, SupplyPlans[SectorIndex]);
+		SectorHelper::RepairFleets(Sector, Company, SupplyPlans[SectorIndex]);
 	}
 
 	for (int32 SectorIndex = 0; SectorIndex < Company->GetKnownSectors().Num(); SectorIndex++)
 	{
 		UFlareSimulatedSector* Sector = Company->GetKnownSectors()[SectorIndex];
-		SectorHelper::RefillFleets(Sector, Company);
+		SectorHelper::RefillFleets(Sector, Company, SupplyPlans[SectorIndex]);
 	}
 }
 
@@ -417,6 +455,63 @@ void UFlareCompanyAI::UpdateBestScore(float Score,
 	}
 }
 
+/*----------------------------------------------------
+	Instrumentation
+----------------------------------------------------*/
+
+void UFlareCompanyAI::AddPhaseTime(EFlareAIPhase::Type Phase, double Seconds)
+{
+	PhaseStats[Phase].Seconds += Seconds;
+	PhaseStats[Phase].Calls++;
+}
+
+void UFlareCompanyAI::ResetPhaseStats()
+{
+	for (int32 PhaseIndex = 0; PhaseIndex < EFlareAIPhase::Count; PhaseIndex++)
+	{
+		PhaseStats[PhaseIndex] = AIPhaseStats();
+	}
+}
+
+const TCHAR* UFlareCompanyAI::GetPhaseName(EFlareAIPhase::Type Phase)
+{
+	switch (Phase)
+	{
+		case EFlareAIPhase::Simulate:                  return TEXT("Simulate");
+		case EFlareAIPhase::UpdateDiplomacy:           return TEXT("UpdateDiplomacy");
+		case EFlareAIPhase::RepairAndRefill:           return TEXT("RepairAndRefill");
+		case EFlareAIPhase::CargosEvasion:             return TEXT("CargosEvasion");
+		case EFlareAIPhase::ProcessBudgetMilitary:     return TEXT("ProcessBudgetMilitary");
+		case EFlareAIPhase::ProcessBudgetTrade:        return TEXT("ProcessBudgetTrade");
+		case EFlareAIPhase::ProcessBudgetStation:      return TEXT("ProcessBudgetStation");
+		case EFlareAIPhase::UpdateMilitaryMovement:    return TEXT("UpdateMilitaryMovement");
+		case EFlareAIPhase::UpdateWarMilitaryMovement: return TEXT("UpdateWarMilitaryMovement");
+		default:                                       return TEXT("Unknown");
+	}
+}
+
+bool UFlareCompanyAI::IsOverTimeBudget() const
+{
+	if (UFlareGameTools::AITimeBudget <= 0)
+	{
+		return false;
+	}
+
+	return (FPlatformTime::Seconds() - DayStartTime) * 1000 > UFlareGameTools::AITimeBudget;
+}
+
+bool UFlareCompanyAI::UseDegradedSearch(EFlareAIPhase::Type Phase)
+{
+	if (!IsOverTimeBudget())
+	{
+		return false;
+	}
+
+	PhaseStats[Phase].DegradedCalls++;
+	return true;
+}
+
+
 /*----------------------------------------------------
 	Budget
 ----------------------------------------------------*/
@@ -579,6 +674,9 @@ void UFlareCompanyAI::ProcessBudget(TArray<EFlareBudget::Type> BudgetToProcess)
 
 void UFlareCompanyAI::ProcessBudgetMilitary(int64 BudgetAmount, bool& Lock, bool& Idle)
 {
+	SCOPE_CYCLE_COUNTER(STAT_FlareCompanyAI_ProcessBudgetMilitary);
+	AIPhaseTimer Timer(this, EFlareAIPhase::ProcessBudgetMilitary);
+
 	// Min confidence level
 	float MinConfidenceLevel = 1;
 
@@ -617,6 +715,9 @@ void UFlareCompanyAI::ProcessBudgetMilitary(int64 BudgetAmount, bool& Lock, bool
 
 void UFlareCompanyAI::ProcessBudgetTrade(int64 BudgetAmount, bool& Lock, bool& Idle)
 {
+	SCOPE_CYCLE_COUNTER(STAT_FlareCompanyAI_ProcessBudgetTrade);
+	AIPhaseTimer Timer(this, EFlareAIPhase::ProcessBudgetTrade);
+
 	int32 DamagedCargosCapacity = GetDamagedCargosCapacity();
 
 	//FLOGV("%s DamagedCargosCapacity=%d", *Company->GetCompanyName().ToString(), DamagedCargosCapacity);
@@ -649,6 +750,9 @@ void UFlareCompanyAI::ProcessBudgetTrade(int64 BudgetAmount, bool& Lock, bool& I
 
 void UFlareCompanyAI::ProcessBudgetStation(int64 BudgetAmount, bool Technology, bool& Lock, bool& Idle)
 {
+	SCOPE_CYCLE_COUNTER(STAT_FlareCompanyAI_ProcessBudgetStation);
+	AIPhaseTimer Timer(this, EFlareAIPhase::ProcessBudgetStation);
+
 	Idle = false;
 	// Prepare resources for station-building analysis
 	float BestScore = 0;
@@ -666,10 +770,35 @@ void UFlareCompanyAI::ProcessBudgetStation(int64 BudgetAmount, bool Technology,
 		}
 	}
 
+	// Collect construction and upgrade candidates, in a stable order
+	TArray<StationConstructionCandidate> Candidates;
+
+	auto AddCandidate = [&Candidates](UFlareSimulatedSector* Sector, FFlareSpacecraftDescription* StationDescription, FFlareFactoryDescription* FactoryDescription, UFlareSimulatedSpacecraft* Station, bool ScoreComputed, float Score)
+	{
+		StationConstructionCandidate Candidate;
+		Candidate.Sector = Sector;
+		Candidate.StationDescription = StationDescription;
+		Candidate.FactoryDescription = FactoryDescription;
+		Candidate.Station = Station;
+		Candidate.ScoreComputed = ScoreComputed;
+		Candidate.Score = Score;
+		Candidates.Add(Candidate);
+	};
+
+	// When over the time budget, only scan a rotating window of known sectors
+	const TArray<UFlareSimulatedSector*>& KnownSectors = Company->GetKnownSectors();
+	int32 SectorCount = KnownSectors.Num();
+	int32 FirstSectorIndex = 0;
+	if (SectorCount > AI_DEGRADED_STATION_SECTOR_COUNT && UseDegradedSearch(EFlareAIPhase::ProcessBudgetStation))
+	{
+		FirstSectorIndex = Game->GetGameWorld()->GetDate() % SectorCount;
+		SectorCount = AI_DEGRADED_STATION_SECTOR_COUNT;
+	}
+
 	// Loop on sector list
-	for (int32 SectorIndex = 0; SectorIndex < Company->GetKnownSectors().Num(); SectorIndex++)
+	for (int32 SectorOffset = 0; SectorOffset < SectorCount; SectorOffset++)
 	{
-		UFlareSimulatedSector* Sector = Company->GetKnownSectors()[SectorIndex];
+		UFlareSimulatedSector* Sector = KnownSectors[(FirstSectorIndex + SectorOffset) % KnownSectors.Num()];
 
 		// Loop on catalog
 		for (int32 StationIndex = 0; StationIndex < StationCatalog.Num(); StationIndex++)
@@ -728,7 +857,7 @@ void UFlareCompanyAI::ProcessBudgetStation(int64 BudgetAmount, bool Technology,
 
 				if(StorageStationCount < 1 && StationCount > AI_MAX_STATION_PER_SECTOR/2)
 				{
-					UpdateBestScore(1e18f, Sector, StationDescription, NULL, &BestScore, &BestStationDescription, &BestStation, &BestSector);
+					AddCandidate(Sector, StationDescription, NULL, NULL, true, 1e18f);
 					break;
 				}
 
@@ -742,15 +871,12 @@ void UFlareCompanyAI::ProcessBudgetStation(int64 BudgetAmount, bool Technology,
 				FFlareFactoryDescription* FactoryDescription = &StationDescription->Factories[FactoryIndex]->Data;
 
 				// Add weight if the company already have another station in this type
-				float Score = ComputeConstructionScoreForStation(Sector, StationDescription, FactoryDescription, NULL, Technology);
-
-				UpdateBestScore(Score, Sector, StationDescription, NULL, &BestScore, &BestStationDescription, &BestStation, &BestSector);
+				AddCandidate(Sector, StationDescription, FactoryDescription, NULL, false, 0);
 			}
 
 			if (StationDescription->Factories.Num() == 0)
 			{
-				float Score = ComputeConstructionScoreForStation(Sector, StationDescription, NULL, NULL, Technology);
-				UpdateBestScore(Score, Sector, StationDescription, NULL, &BestScore, &BestStationDescription, &BestStation, &BestSector);
+				AddCandidate(Sector, StationDescription, NULL, NULL, false, 0);
 			}
 		}
 
@@ -832,7 +958,7 @@ void UFlareCompanyAI::ProcessBudgetStation(int64 BudgetAmount, bool Technology,
 
 					if(Station->GetLevel() < StationLevelMean)
 					{
-						UpdateBestScore(1e17f, Sector, Station->GetDescription(), Station, &BestScore, &BestStationDescription, &BestStation, &BestSector);
+						AddCandidate(Sector, Station->GetDescription(), NULL, Station, true, 1e17f);
 						break;
 					}
 				}
@@ -844,20 +970,37 @@ void UFlareCompanyAI::ProcessBudgetStation(int64 BudgetAmount, bool Technology,
 				FFlareFactoryDescription* FactoryDescription = &Station->GetDescription()->Factories[FactoryIndex]->Data;
 
 				// Add weight if the company already have another station in this type
-				float Score = ComputeConstructionScoreForStation(Sector, Station->GetDescription(), FactoryDescription, Station, Technology);
-
-				UpdateBestScore(Score, Sector, Station->GetDescription(), Station, &BestScore, &BestStationDescription, &BestStation, &BestSector);
+				AddCandidate(Sector, Station->GetDescription(), FactoryDescription, Station, false, 0);
 			}
 
 			if (Station->GetDescription()->Factories.Num() == 0)
 			{
-				float Score = ComputeConstructionScoreForStation(Sector, Station->GetDescription(), NULL, Station, Technology);
-				UpdateBestScore(Score, Sector, Station->GetDescription(), Station, &BestScore, &BestStationDescription, &BestStation, &BestSector);
+				AddCandidate(Sector, Station->GetDescription(), NULL, Station, false, 0);
 			}
 
 		}
 	}
 
+	// Score candidates on the game thread : scoring reads UObject state and fills lazy sector caches
+	{
+		SCOPE_CYCLE_COUNTER(STAT_FlareCompanyAI_ProcessBudgetStation_Scoring);
+
+		for (StationConstructionCandidate& Candidate : Candidates)
+		{
+			if (!Candidate.ScoreComputed)
+			{
+				Candidate.Score = ComputeConstructionScoreForStation(Candidate.Sector, Candidate.StationDescription, Candidate.FactoryDescription, Candidate.Station, Technology);
+				Candidate.ScoreComputed = true;
+			}
+		}
+	}
+
+	// Pick the best candidate in collection order
+	for (StationConstructionCandidate& Candidate : Candidates)
+	{
+		UpdateBestScore(Candidate.Score, Candidate.Sector, Candidate.StationDescription, Candidate.Station, &BestScore, &BestStationDescription, &BestStation, &BestSector);
+	}
+
 	if (BestSector && BestStationDescription)
 	{
 #ifdef DEBUG_AI_BUDGET
@@ -958,6 +1101,7 @@ int64 UFlareCompanyAI::UpdateWarShipAcquisition(bool limitToOne)
 void UFlareCompanyAI::UpdateMilitaryMovement()
 {
 	SCOPE_CYCLE_COUNTER(STAT_FlareCompanyAI_UpdateMilitaryMovement);
+	AIPhaseTimer Timer(this, EFlareAIPhase::UpdateMilitaryMovement);
 
 	if (Company->AtWar())
 	{
@@ -1181,19 +1325,34 @@ TArray<WarTarget> UFlareCompanyAI::GenerateWarTargetList(AIWarContext& WarContex
 			IsTarget = true;
 		}
 
-		for (UFlareSimulatedSpacecraft* Spacecraft : Sector->GetSectorSpacecrafts())
+		for (auto& CompanyEntry : Sector->GetSpacecraftsByCompany())
 		{
-			if (!Spacecraft->IsStation() && !Spacecraft->IsMilitary() && Spacecraft->GetDamageSystem()->IsUncontrollable())
+			if (IsTarget)
+			{
+				break;
+			}
+
+			if (!WarContext.Enemies.Contains(CompanyEntry.Key))
 			{
-				// Don't target uncontrollable ships
 				continue;
 			}
 
-			if (WarContext.Enemies.Contains(Spacecraft->GetCompany()))
+			const SectorCompanySpacecrafts& EnemySpacecrafts = CompanyEntry.Value;
+			if (EnemySpacecrafts.Stations.Num() > 0 || EnemySpacecrafts.MilitaryShips.Num() > 0)
 			{
 				IsTarget = true;
 				break;
 			}
+
+			for (UFlareSimulatedSpacecraft* Spacecraft : EnemySpacecrafts.CargoShips)
+			{
+				// Don't target uncontrollable ships
+				if (!Spacecraft->GetDamageSystem()->IsUncontrollable())
+				{
+					IsTarget = true;
+					break;
+				}
+			}
 		}
 
 		if (!IsTarget)
@@ -1217,69 +1376,56 @@ TArray<WarTarget> UFlareCompanyAI::GenerateWarTargetList(AIWarContext& WarContex
 		Target.WarTargetIncomingFleets = GenerateWarTargetIncomingFleets(WarContext, Sector);
 
 
-		for (UFlareSimulatedSpacecraft* Spacecraft : Sector->GetSectorSpacecrafts())
+		for (auto& CompanyEntry : Sector->GetSpacecraftsByCompany())
 		{
-			if (WarContext.Enemies.Contains(Spacecraft->GetCompany()))
+			UFlareCompany* OtherCompany = CompanyEntry.Key;
+			const SectorCompanySpacecrafts& OtherSpacecrafts = CompanyEntry.Value;
+
+			if (WarContext.Enemies.Contains(OtherCompany))
 			{
-				if (Spacecraft->IsStation())
-				{
-					Target.EnemyStationCount++;
-				}
-				else
-				{
-					if (Spacecraft->IsMilitary())
-					{
-						int32 ShipCombatPoints = Spacecraft->GetCombatPoints(true);
-						Target.EnemyArmyCombatPoints += ShipCombatPoints;
+				Target.EnemyStationCount += OtherSpacecrafts.Stations.Num();
+				Target.EnemyCargoCount += OtherSpacecrafts.CargoShips.Num();
 
-						if (Spacecraft->GetSize() == EFlarePartSize::L)
-						{
-							Target.EnemyArmyLCombatPoints += ShipCombatPoints;
-						}
-						else
-						{
-							Target.EnemyArmySCombatPoints += ShipCombatPoints;
-						}
+				for (UFlareSimulatedSpacecraft* Spacecraft : OtherSpacecrafts.MilitaryShips)
+				{
+					int32 ShipCombatPoints = Spacecraft->GetCombatPoints(true);
+					Target.EnemyArmyCombatPoints += ShipCombatPoints;
 
-						if(ShipCombatPoints > 0)
-						{
-							Target.ArmedDefenseCompanies.AddUnique(Spacecraft->GetCompany());
-						}
+					if (Spacecraft->GetSize() == EFlarePartSize::L)
+					{
+						Target.EnemyArmyLCombatPoints += ShipCombatPoints;
 					}
 					else
 					{
-						Target.EnemyCargoCount++;
+						Target.EnemyArmySCombatPoints += ShipCombatPoints;
+					}
+
+					if(ShipCombatPoints > 0)
+					{
+						Target.ArmedDefenseCompanies.AddUnique(OtherCompany);
 					}
 				}
 			}
-			else if (WarContext.Allies.Contains(Spacecraft->GetCompany()))
+			else if (WarContext.Allies.Contains(OtherCompany))
 			{
-				if (Spacecraft->IsStation())
-				{
-					Target.OwnedStationCount++;
-				}
-				else
-				{
-					if (Spacecraft->IsMilitary())
-					{
-						int32 ShipCombatPoints= Spacecraft->GetCombatPoints(true);
+				Target.OwnedStationCount += OtherSpacecrafts.Stations.Num();
+				Target.OwnedCargoCount += OtherSpacecrafts.CargoShips.Num();
+				Target.OwnedMilitaryCount += OtherSpacecrafts.MilitaryShips.Num();
 
-						Target.OwnedArmyCombatPoints += ShipCombatPoints;
-						Target.OwnedMilitaryCount++;
+				for (UFlareSimulatedSpacecraft* Spacecraft : OtherSpacecrafts.MilitaryShips)
+				{
+					int32 ShipCombatPoints= Spacecraft->GetCombatPoints(true);
 
-						if (Spacecraft->GetWeaponsSystem()->HasAntiLargeShipWeapon())
-						{
-							Target.OwnedArmyAntiLCombatPoints += ShipCombatPoints;
-						}
+					Target.OwnedArmyCombatPoints += ShipCombatPoints;
 
-						if (Spacecraft->GetWeaponsSystem()->HasAntiSmallShipWeapon())
-						{
-							Target.OwnedArmyAntiSCombatPoints += ShipCombatPoints;
-						}
+					if (Spacecraft->GetWeaponsSystem()->HasAntiLargeShipWeapon())
+					{
+						Target.OwnedArmyAntiLCombatPoints += ShipCombatPoints;
 					}
-					else
+
+					if (Spacecraft->GetWeaponsSystem()->HasAntiSmallShipWeapon())
 					{
-						Target.OwnedCargoCount++;
+						Target.OwnedArmyAntiSCombatPoints += ShipCombatPoints;
 					}
 				}
 			}
@@ -1353,62 +1499,65 @@ TArray<DefenseSector> UFlareCompanyAI::GenerateDefenseSectorList(AIWarContext& W
 			// Keep prisoners
 			int32 MinCombatPoints = MAX_int32;
 
-			for (UFlareSimulatedSpacecraft* Ship : Sector->GetSectorShips())
+			for (UFlareCompany* Ally : WarContext.Allies)
 			{
-				int32 ShipCombatPoints= Ship->GetCombatPoints(true);
-
-				if (!WarContext.Allies.Contains(Ship->GetCompany())
-				 || Ship->CanTravel() == false
-				 || ShipCombatPoints == 0)
+				for (UFlareSimulatedSpacecraft* Ship : Sector->GetCompanySpacecrafts(Ally).MilitaryShips)
 				{
-					continue;
-				}
+					int32 ShipCombatPoints= Ship->GetCombatPoints(true);
 
-				if (ShipCombatPoints < MinCombatPoints)
-				{
-					MinCombatPoints = ShipCombatPoints;
-					Target.PrisonersKeeper = Ship;
+					if (Ship->CanTravel() == false
+					 || ShipCombatPoints == 0)
+					{
+						continue;
+					}
+
+					if (ShipCombatPoints < MinCombatPoints)
+					{
+						MinCombatPoints = ShipCombatPoints;
+						Target.PrisonersKeeper = Ship;
+					}
 				}
 			}
 		}
 
-		for (UFlareSimulatedSpacecraft* Ship : Sector->GetSectorShips())
+		for (UFlareCompany* Ally : WarContext.Allies)
 		{
-			int32 ShipCombatPoints= Ship->GetCombatPoints(true);
-
-			if (!WarContext.Allies.Contains(Ship->GetCompany())
-			 || Ship->CanTravel() == false
-			 || ShipCombatPoints == 0
-			 || Ship == Target.PrisonersKeeper)
+			for (UFlareSimulatedSpacecraft* Ship : Sector->GetCompanySpacecrafts(Ally).MilitaryShips)
 			{
-				continue;
-			}
-			
-			Target.CombatPoints += ShipCombatPoints;
-			if (Ship->GetSize() == EFlarePartSize::L)
-			{
-				Target.ArmyLargeShipCombatPoints += ShipCombatPoints;
-				Target.LargeShipArmyCount++;
-			}
-			else
-			{
-				Target.ArmySmallShipCombatPoints += ShipCombatPoints;
-				Target.SmallShipArmyCount++;
-			}
+				int32 ShipCombatPoints= Ship->GetCombatPoints(true);
 
-			if (Ship->GetWeaponsSystem()->HasAntiLargeShipWeapon())
-			{
-				Target.ArmyAntiLCombatPoints += ShipCombatPoints;
-			}
+				if (Ship->CanTravel() == false
+				 || ShipCombatPoints == 0
+				 || Ship == Target.PrisonersKeeper)
+				{
+					continue;
+				}
 
-			if (Ship->GetWeaponsSystem()->HasAntiSmallShipWeapon())
-			{
-				Target.ArmyAntiSCombatPoints += ShipCombatPoints;
+				Target.CombatPoints += ShipCombatPoints;
+				if (Ship->GetSize() == EFlarePartSize::L)
+				{
+					Target.ArmyLargeShipCombatPoints += ShipCombatPoints;
+					Target.LargeShipArmyCount++;
+				}
+				else
+				{
+					Target.ArmySmallShipCombatPoints += ShipCombatPoints;
+					Target.SmallShipArmyCount++;
+				}
+
+				if (Ship->GetWeaponsSystem()->HasAntiLargeShipWeapon())
+				{
+					Target.ArmyAntiLCombatPoints += ShipCombatPoints;
+				}
+
+				if (Ship->GetWeaponsSystem()->HasAntiSmallShipWeapon())
+				{
+					Target.ArmyAntiSCombatPoints += ShipCombatPoints;
+				}
 			}
 		}
 
 		Target.CapturingStation = false;
-		TArray<UFlareSimulatedSpacecraft*>& Stations =  Sector->GetSectorStations();
 
 
 		if(Company->GetCaptureOrderCountInSector(Sector) > 0)
@@ -1417,12 +1566,20 @@ TArray<DefenseSector> UFlareCompanyAI::GenerateDefenseSectorList(AIWarContext& W
 		}
 		else
 		{
-			for (UFlareSimulatedSpacecraft* Station : Stations)
+			for (UFlareCompany* Enemy : WarContext.Enemies)
 			{
-				// Capturing station
-				if (WarContext.Enemies.Contains(Station->GetCompany()) && Company->CanStartCapture(Station))
+				for (UFlareSimulatedSpacecraft* Station : Sector->GetCompanySpacecrafts(Enemy).Stations)
+				{
+					// Capturing station
+					if (Company->CanStartCapture(Station))
+					{
+						Target.CapturingStation = true;
+						break;
+					}
+				}
+
+				if (Target.CapturingStation)
 				{
-					Target.CapturingStation = true;
 					break;
 				}
 			}
@@ -1444,15 +1601,17 @@ TArray<UFlareSimulatedSpacecraft*> UFlareCompanyAI::GenerateWarShipList(AIWarCon
 {
 	TArray<UFlareSimulatedSpacecraft*> WarShips;
 
-	for (UFlareSimulatedSpacecraft* Ship : Sector->GetSectorShips())
+	for (UFlareCompany* Ally : WarContext.Allies)
 	{
-		if (WarContext.Allies.Contains(Ship->GetCompany())
-		 &&  Ship->CanTravel()
-		 && !Ship->GetDamageSystem()->IsDisarmed()
-		 && !Ship->GetDamageSystem()->IsStranded()
-		 && Ship != ExcludeShip)
+		for (UFlareSimulatedSpacecraft* Ship : Sector->GetCompanySpacecrafts(Ally).Ships)
 		{
-			WarShips.Add(Ship);
+			if (Ship->CanTravel()
+			 && !Ship->GetDamageSystem()->IsDisarmed()
+			 && !Ship->GetDamageSystem()->IsStranded()
+			 && Ship != ExcludeShip)
+			{
+				WarShips.Add(Ship);
+			}
 		}
 	}
 
@@ -1520,11 +1679,19 @@ void AIWarContext::Generate()
 	float AttackThresholdSum = 0;
 	float AttackThresholdCount = 0;
 
+	TSet<UFlareSimulatedSector*> KnownSectorSet;
+	KnownSectors.Empty();
+
 	for (UFlareCompany* Ally :  Allies)
 	{
 		for(UFlareSimulatedSector* Sector: Ally->GetKnownSectors())
 		{
-			KnownSectors.AddUnique(Sector);
+			bool AlreadyKnown = false;
+			KnownSectorSet.Add(Sector, &AlreadyKnown);
+			if (!AlreadyKnown)
+			{
+				KnownSectors.Add(Sector);
+			}
 		}
 
 		Ally->GetAI()->GetBehavior()->Load(Ally);
@@ -1536,8 +1703,34 @@ void AIWarContext::Generate()
 	AttackThreshold = AttackThresholdSum/AttackThresholdCount;
 }
 
+const AIWarContext* UFlareCompanyAI::FindDailyWarContext(int32 AlliesCode, const TArray<UFlareCompany*>& Allies) const
+{
+	if (DailyWarContext.Date != Game->GetGameWorld()->GetDate() || DailyWarContext.AlliesCode != AlliesCode)
+	{
+		return nullptr;
+	}
+
+	// Diplomacy may have changed since this context was built, so the alliance must still be the same
+	if (DailyWarContext.Allies.Num() != Allies.Num())
+	{
+		return nullptr;
+	}
+
+	for (UFlareCompany* Ally : Allies)
+	{
+		if (!DailyWarContext.Allies.Contains(Ally))
+		{
+			return nullptr;
+		}
+	}
+
+	return &DailyWarContext;
+}
+
 void UFlareCompanyAI::UpdateWarMilitaryMovement()
 {
+	SCOPE_CYCLE_COUNTER(STAT_FlareCompanyAI_UpdateWarMilitaryMovement);
+	AIPhaseTimer Timer(this, EFlareAIPhase::UpdateWarMilitaryMovement);
 
 	auto GenerateAlliesCode = [&](UFlareCompany* iCompany)
 	{
@@ -1592,11 +1785,43 @@ void UFlareCompanyAI::UpdateWarMilitaryMovement()
 		return Enemies;
 	};
 
-	AIWarContext WarContext;
+	// The war context only depends on the alliance, so allies share it for the day
+	int64 Date = Game->GetGameWorld()->GetDate();
+	int32 AlliesCode = GenerateAlliesCode(Company);
 
-	WarContext.Allies = GenerateAlliesList();
-	WarContext.Enemies = GenerateEnemiesList();
-	WarContext.Generate();
+	if (DailyWarContext.Date != Date || DailyWarContext.AlliesCode != AlliesCode)
+	{
+		TArray<UFlareCompany*> Allies = GenerateAlliesList();
+		const AIWarContext* AllyWarContext = nullptr;
+
+		for (UFlareCompany* Ally : Allies)
+		{
+			if (Ally != Company)
+			{
+				AllyWarContext = Ally->GetAI()->FindDailyWarContext(AlliesCode, Allies);
+				if (AllyWarContext)
+				{
+					break;
+				}
+			}
+		}
+
+		if (AllyWarContext)
+		{
+			// Same allies, whose behaviors were loaded when the context was generated
+			DailyWarContext = *AllyWarContext;
+		}
+		else
+		{
+			DailyWarContext.Allies = Allies;
+			DailyWarContext.Enemies = GenerateEnemiesList();
+			DailyWarContext.Generate();
+			DailyWarContext.AlliesCode = AlliesCode;
+			DailyWarContext.Date = Date;
+		}
+	}
+
+	AIWarContext& WarContext = DailyWarContext;
 
 	TArray<WarTarget> TargetList = GenerateWarTargetList(WarContext);
 	TArray<DefenseSector> DefenseSectorList = GenerateDefenseSectorList(WarContext);
@@ -1608,10 +1833,26 @@ void UFlareCompanyAI::UpdateWarMilitaryMovement()
 		DefenseSectorList.Num());
 #endif
 
+	// When over the time budget, only consider the most important targets for attacks, with a coarser battle prediction
+	int32 BattlePredictionTrials = AI_BATTLE_PREDICTION_TRIALS;
+	int32 AttackTargetCount = TargetList.Num();
+	if (UseDegradedSearch(EFlareAIPhase::UpdateWarMilitaryMovement))
+	{
+		BattlePredictionTrials = AI_DEGRADED_BATTLE_PREDICTION_TRIALS;
+		AttackTargetCount = FMath::Min(AttackTargetCount, AI_DEGRADED_WAR_TARGET_COUNT);
+	}
+
 	// Manage attacking fleets
-	for (WarTarget& Target : TargetList)
+	for (int32 TargetIndex = 0; TargetIndex < AttackTargetCount; TargetIndex++)
 	{
+		WarTarget& Target = TargetList[TargetIndex];
 		TArray<DefenseSector> SortedDefenseSectorList = SortSectorsByDistance(Target.Sector, DefenseSectorList);
+
+		// Fleets in the target sector, summarized once for the battle predictor
+		BattleFleetSummary EnemyFleet;
+		BattleFleetSummary LocalFleet;
+		bool TargetFleetsSummarized = false;
+
 		for (DefenseSector& Sector : SortedDefenseSectorList)
 		{
 #ifdef DEBUG_AI_WAR_MILITARY_MOVEMENT
@@ -1710,6 +1951,53 @@ void UFlareCompanyAI::UpdateWarMilitaryMovement()
 				}
 			}
 
+			// Check the full army would win the battle
+			if (Target.EnemyArmyCombatPoints > 0)
+			{
+				if (!TargetFleetsSummarized)
+				{
+					// Follow the sector ship order, the summaries depend on the order ships are added
+					for (UFlareSimulatedSpacecraft* Ship : Target.Sector->GetSectorShips())
+					{
+						if (!Ship->IsMilitary())
+						{
+							continue;
+						}
+
+						if (WarContext.Enemies.Contains(Ship->GetCompany()))
+						{
+							EnemyFleet.AddShip(Ship);
+						}
+						else if (WarContext.Allies.Contains(Ship->GetCompany()))
+						{
+							LocalFleet.AddShip(Ship);
+						}
+					}
+					TargetFleetsSummarized = true;
+				}
+
+				BattleFleetSummary AttackFleet = LocalFleet;
+				for (UFlareSimulatedSpacecraft* Ship : MovableShips)
+				{
+					AttackFleet.AddShip(Ship);
+				}
+
+				// Hash the identifier text, FName hashes depend on the name registration order
+				int32 Seed = GetTypeHash(Target.Sector->GetIdentifier().ToString()) ^ int32(Game->GetGameWorld()->GetDate());
+				BattlePrediction Prediction = BattlePredictor::Predict(AttackFleet, EnemyFleet, BattlePredictionTrials, Seed);
+
+				if (Prediction.WinProbability < AI_BATTLE_MIN_WIN_PROBABILITY)
+				{
+#ifdef DEBUG_AI_WAR_MILITARY_MOVEMENT
+					FLOGV("army at %s won't attack %s : win probability %f, expected losses %f against %f",
+						*Sector.Sector->GetSectorName().ToString(),
+						*Target.Sector->GetSectorName().ToString(),
+						Prediction.WinProbability, Prediction.AttackerExpectedLosses, Prediction.DefenderExpectedLosses);
+#endif
+					continue;
+				}
+			}
+
 #ifdef DEBUG_AI_WAR_MILITARY_MOVEMENT
 			FLOGV("army at %s attack %s !",
 				*Sector.Sector->GetSectorName().ToString(),
@@ -1804,10 +2092,13 @@ void UFlareCompanyAI::UpdateWarMilitaryMovement()
 
 		TArray<UFlareSimulatedSpacecraft*> MovableShips = GenerateWarShipList(WarContext, Sector.Sector, Sector.PrisonersKeeper);
 
-		SectorHelper::GetRefillFleetSupplyNeeds(Sector.Sector, MovableShips, NeededFS, TotalNeededFS, MaxDuration, true);
+		SectorHelper::FlareFleetSupplyPlan SupplyPlan;
+		SectorHelper::ComputeFleetSupplyPlan(Sector.Sector, MovableShips, true, SupplyPlan);
+
+		SectorHelper::GetRefillFleetSupplyNeeds(SupplyPlan, NeededFS, TotalNeededFS, MaxDuration);
 		CumulatedTotalNeededFS += TotalNeededFS;
 
-		SectorHelper::GetRepairFleetSupplyNeeds(Sector.Sector, MovableShips, NeededFS, TotalNeededFS, MaxDuration, true);
+		SectorHelper::GetRepairFleetSupplyNeeds(SupplyPlan, NeededFS, TotalNeededFS, MaxDuration);
 		CumulatedTotalNeededFS += TotalNeededFS;
 
 		if (CumulatedTotalNeededFS > 0)
@@ -2568,6 +2859,7 @@ int64 UFlareCompanyAI::OrderOneShip(const FFlareSpacecraftDescription* ShipDescr
 				FName ShipClassToOrder = ShipDescription->Identifier;
 				FLOGV("UFlareCompanyAI::UpdateShipAcquisition : Ordering spacecraft : '%s'", *ShipClassToOrder.ToString());
 				Shipyard->ShipyardOrderShip(Company, ShipClassToOrder);
+				BestShipChoices[ShipDescription->IsMilitary() ? 1 : 0] = AIShipChoice();
 
 				SpendBudget((ShipDescription->IsMilitary() ? EFlareBudget::Military : EFlareBudget::Trade), ShipPrice);
 
@@ -2596,6 +2888,23 @@ const FFlareSpacecraftDescription* UFlareCompanyAI::FindBestShipToBuild(bool Mil
 		return nullptr;
 	}
 
+	// Reuse today's choice while the fleet is unchanged
+	AIShipChoice& Choice = BestShipChoices[Military ? 1 : 0];
+	int64 Date = Game->GetGameWorld()->GetDate();
+	if (Choice.Date == Date && Choice.ShipCount == TotalCompanyShipCount)
+	{
+		return Choice.Description;
+	}
+
+	// When over the time budget, keep the last choice even if it is older or the fleet changed
+	if (Choice.Description && UseDegradedSearch(Military ? EFlareAIPhase::ProcessBudgetMilitary : EFlareAIPhase::ProcessBudgetTrade))
+	{
+		return Choice.Description;
+	}
+	Choice.Date = Date;
+	Choice.ShipCount = TotalCompanyShipCount;
+	Choice.Description = nullptr;
+
 	// Count owned ships
 	TMap<const FFlareSpacecraftDescription*, int32> OwnedShipSCount;
 	TMap<const FFlareSpacecraftDescription*, int32> OwnedShipLCount;
@@ -2703,50 +3012,7 @@ const FFlareSpacecraftDescription* UFlareCompanyAI::FindBestShipToBuild(bool Mil
 #endif
 
 	// List possible ship candidates
-	TArray<const FFlareSpacecraftDescription*> CandidateShips;
-	for (auto& CatalogEntry : Game->GetSpacecraftCatalog()->ShipCatalog)
-	{
-		const FFlareSpacecraftDescription* Description = &CatalogEntry->Data;
-		if (Military == Description->IsMilitary())
-		{
-			if (PickLShip == (Description->Size == EFlarePartSize::L))
-			{
-				CandidateShips.Add(Description);
-			}
-		}
-	}
-	
-	// Sort by size
-	struct FSortBySmallerShip
-	{
-		FORCEINLINE bool operator()(const FFlareSpacecraftDescription& A, const FFlareSpacecraftDescription& B) const
-		{			
-			if (A.Mass > B.Mass)
-			{
-				return false;
-			}
-			else if (A.Mass < B.Mass)
-			{
-				return true;
-			}
-			else if (A.IsMilitary())
-			{
-				if (!B.IsMilitary())
-				{
-					return false;
-				}
-				else
-				{
-					return A.WeaponGroups.Num() < B.WeaponGroups.Num();
-				}
-			}
-			else
-			{
-				return true;
-			}
-		}
-	};
-	CandidateShips.Sort(FSortBySmallerShip());
+	const TArray<const FFlareSpacecraftDescription*>& CandidateShips = GetSortedShipCandidates(Military, PickLShip);
 
 	// Find the first ship that is diverse enough, from small to large
 	const FFlareSpacecraftDescription* BestShipDescription = NULL;
@@ -2795,9 +3061,70 @@ const FFlareSpacecraftDescription* UFlareCompanyAI::FindBestShipToBuild(bool Mil
 		return NULL;
 	}
 
+	Choice.Description = BestShipDescription;
 	return BestShipDescription;
 }
 
+const TArray<const FFlareSpacecraftDescription*>& UFlareCompanyAI::GetSortedShipCandidates(bool Military, bool LargeShip)
+{
+	int32 CandidateIndex = (Military ? 2 : 0) + (LargeShip ? 1 : 0);
+
+	if (!SortedShipCandidatesValid)
+	{
+		for (int32 Index = 0; Index < 4; Index++)
+		{
+			SortedShipCandidates[Index].Empty();
+		}
+
+		for (auto& CatalogEntry : Game->GetSpacecraftCatalog()->ShipCatalog)
+		{
+			const FFlareSpacecraftDescription* Description = &CatalogEntry->Data;
+			int32 Index = (Description->IsMilitary() ? 2 : 0) + (Description->Size == EFlarePartSize::L ? 1 : 0);
+			SortedShipCandidates[Index].Add(Description);
+		}
+
+		// Sort by size
+		struct FSortBySmallerShip
+		{
+			FORCEINLINE bool operator()(const FFlareSpacecraftDescription& A, const FFlareSpacecraftDescription& B) const
+			{			
+				if (A.Mass > B.Mass)
+				{
+					return false;
+				}
+				else if (A.Mass < B.Mass)
+				{
+					return true;
+				}
+				else if (A.IsMilitary())
+				{
+					if (!B.IsMilitary())
+					{
+						return false;
+					}
+					else
+					{
+						return A.WeaponGroups.Num() < B.WeaponGroups.Num();
+					}
+				}
+				else
+				{
+					return true;
+				}
+			}
+		};
+
+		for (int32 Index = 0; Index < 4; Index++)
+		{
+			SortedShipCandidates[Index].Sort(FSortBySmallerShip());
+		}
+
+		SortedShipCandidatesValid = true;
+	}
+
+	return SortedShipCandidates[CandidateIndex];
+}
+
 bool UFlareCompanyAI::IsBuildingShip(bool Military)
 {
 	for (int32 ShipyardIndex = 0; ShipyardIndex < Shipyards.Num(); ShipyardIndex++)
@@ -2826,56 +3153,19 @@ bool UFlareCompanyAI::IsBuildingShip(bool Military)
 TArray<UFlareSimulatedSpacecraft*> UFlareCompanyAI::FindShipyards()
 {
 	TArray<UFlareSimulatedSpacecraft*> ShipyardList;
-
-	// Find shipyard
-	for (int32 SectorIndex = 0; SectorIndex < Company->GetKnownSectors().Num(); SectorIndex++)
-	{
-		UFlareSimulatedSector* Sector = Company->GetKnownSectors()[SectorIndex];
-
-		for (int32 StationIndex = 0; StationIndex < Sector->GetSectorStations().Num(); StationIndex++)
-		{
-			UFlareSimulatedSpacecraft* Station = Sector->GetSectorStations()[StationIndex];
-
-			if (Company->GetWarState(Station->GetCompany()) == EFlareHostility::Hostile)
-			{
-				continue;
-			}
-
-			TArray<UFlareFactory*>& Factories = Station->GetFactories();
-
-			for (int32 Index = 0; Index < Factories.Num(); Index++)
-			{
-				UFlareFactory* Factory = Factories[Index];
-				if (Factory->IsShipyard())
-				{
-					ShipyardList.Add(Station);
-					break;
-				}
-			}
-		}
-	}
-
+	Game->GetGameWorld()->GetCompanyShipyards(Company, ShipyardList);
 	return ShipyardList;
 }
 
-TArray<UFlareSimulatedSpacecraft*> UFlareCompanyAI::FindIncapacitatedCargos() const
+const TArray<UFlareSimulatedSpacecraft*>& UFlareCompanyAI::FindIncapacitatedCargos() const
 {
-	TArray<UFlareSimulatedSpacecraft*> IncapacitatedCargos;
-
-	for (UFlareSimulatedSpacecraft* Ship : Company->GetCompanyShips())
-	{
-		if (Ship->GetActiveCargoBay()->GetCapacity() > 0 && (Ship->GetDamageSystem()->IsStranded() || Ship->GetDamageSystem()->IsUncontrollable()))
-		{
-			IncapacitatedCargos.Add(Ship);
-		}
-	}
-
-	return IncapacitatedCargos;
+	return FleetStats.IncapacitatedCargos;
 }
 
 void UFlareCompanyAI::CargosEvasion()
 {
 	SCOPE_CYCLE_COUNTER(STAT_FlareCompanyAI_CargosEvasion);
+	AIPhaseTimer Timer(this, EFlareAIPhase::CargosEvasion);
 
 	for (int32 SectorIndex = 0; SectorIndex < Company->GetKnownSectors().Num(); SectorIndex++)
 	{
@@ -2949,68 +3239,64 @@ void UFlareCompanyAI::CargosEvasion()
 	}
 }
 
-int32 UFlareCompanyAI::GetDamagedCargosCapacity()
+int32 UFlareCompanyAI::GetDamagedCargosCapacity() const
 {
-	int32 DamagedCapacity = 0;
-	for (int32 SectorIndex = 0; SectorIndex < Company->GetKnownSectors().Num(); SectorIndex++)
-	{
-		UFlareSimulatedSector* Sector = Company->GetKnownSectors()[SectorIndex];
-		
-		for (int32 ShipIndex = 0 ; ShipIndex < Sector->GetSectorShips().Num(); ShipIndex++)
-		{
-			UFlareSimulatedSpacecraft* Ship = Sector->GetSectorShips()[ShipIndex];
-			if (Ship->GetCompany() != Company || Ship->IsTrading() || (Ship->GetCurrentFleet() && Ship->GetCurrentFleet()->IsTraveling()) || Ship->GetCurrentTradeRoute() != NULL || Ship->GetActiveCargoBay()->GetCapacity() == 0)
-			{
-				continue;
-			}
+	return FleetStats.DamagedCargosCapacity;
+}
 
-			if (Ship->GetDamageSystem()->IsStranded())
-			{
-				DamagedCapacity += Ship->GetActiveCargoBay()->GetCapacity();
-			}
+int32 UFlareCompanyAI::GetCargosCapacity() const
+{
+	return FleetStats.CargosCapacity;
+}
 
-		}
-	}
-	return DamagedCapacity;
+const TArray<UFlareSimulatedSpacecraft*>& UFlareCompanyAI::FindIdleMilitaryShips() const
+{
+	return FleetStats.IdleMilitaryShips;
 }
 
-int32 UFlareCompanyAI::GetCargosCapacity()
+void UFlareCompanyAI::UpdateFleetStats()
 {
-	int32 Capacity = 0;
-	for (UFlareSimulatedSpacecraft* Ship : Company->GetCompanyShips())
+	FleetStats = AIFleetStats();
+
+	for (UFlareSimulatedSpacecraft* Spacecraft : Company->GetCompanySpacecrafts())
 	{
-		if (Ship->GetCompany() != Company || Ship->GetActiveCargoBay()->GetCapacity() == 0)
+		UFlareSimulatedSpacecraftDamageSystem* DamageSystem = Spacecraft->GetDamageSystem();
+
+		if (DamageSystem->GetGlobalDamageRatio() < 0.99)
 		{
-			continue;
+			FleetStats.DamagedSpacecraftCount++;
 		}
 
-		Capacity += Ship->GetActiveCargoBay()->GetCapacity();
-	}
-	return Capacity;
-}
+		if (Spacecraft->IsStation())
+		{
+			continue;
+		}
 
-TArray<UFlareSimulatedSpacecraft*> UFlareCompanyAI::FindIdleMilitaryShips() const
-{
-	TArray<UFlareSimulatedSpacecraft*> IdleMilitaryShips;
+		bool IsTraveling = (!Spacecraft->GetCurrentSector() || (Spacecraft->GetCurrentFleet() && Spacecraft->GetCurrentFleet()->IsTraveling()));
+		int32 Capacity = Spacecraft->GetActiveCargoBay()->GetCapacity();
 
-	for (int32 SectorIndex = 0; SectorIndex < Company->GetKnownSectors().Num(); SectorIndex++)
-	{
-		UFlareSimulatedSector* Sector = Company->GetKnownSectors()[SectorIndex];
+		if (Capacity > 0)
+		{
+			bool IsStranded = DamageSystem->IsStranded();
+			FleetStats.CargosCapacity += Capacity;
 
+			if (IsStranded || DamageSystem->IsUncontrollable())
+			{
+				FleetStats.IncapacitatedCargos.Add(Spacecraft);
+			}
 
-		for (int32 ShipIndex = 0 ; ShipIndex < Sector->GetSectorShips().Num(); ShipIndex++)
-		{
-			UFlareSimulatedSpacecraft* Ship = Sector->GetSectorShips()[ShipIndex];
-			if (Ship->GetCompany() != Company || !Ship->IsMilitary() || (Ship->GetCurrentFleet() && Ship->GetCurrentFleet()->IsTraveling()))
+			// Stranded cargos waiting in a sector
+			if (IsStranded && !IsTraveling && !Spacecraft->IsTrading() && Spacecraft->GetCurrentTradeRoute() == NULL)
 			{
-				continue;
+				FleetStats.DamagedCargosCapacity += Capacity;
 			}
+		}
 
-			IdleMilitaryShips.Add(Ship);
+		if (Spacecraft->IsMilitary() && !IsTraveling)
+		{
+			FleetStats.IdleMilitaryShips.Add(Spacecraft);
 		}
 	}
-
-	return IdleMilitaryShips;
 }
 
 float UFlareCompanyAI::GetShipyardUsageRatio() const
@@ -3074,6 +3360,7 @@ float UFlareCompanyAI::ComputeConstructionScoreForStation(UFlareSimulatedSector*
 	//
 	// - Time to pay the construction price multiply from 1 for 1 day to 0 for infinity. 0.5 at 200 days
 
+	const TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats>& WorldStats = Game->GetGameWorld()->GetWorldResourceStats();
 	float Score = 1.0f;
 
 	/*if (StationDescription->Capabilities.Contains(EFlareSpacecraftCapability::Maintenance))
@@ -3098,20 +3385,19 @@ float UFlareCompanyAI::ComputeConstructionScoreForStation(UFlareSimulatedSector*
 	{
 		Score *= Behavior->ConsumerAffility;
 
-		const SectorVariation* ThisSectorVariation = &WorldResourceVariation[Sector];
+		// Same consumer capacity for every consumer resource
+		int32 ConsumerMaxStock = Game->GetGameWorld()->GetSectorStockCapacity(Sector).GetConsumerMaxStock(Company);
 
 		float MaxScoreModifier = 0;
 
 		for (int32 ResourceIndex = 0; ResourceIndex < Game->GetResourceCatalog()->ConsumerResources.Num(); ResourceIndex++)
 		{
 			FFlareResourceDescription* Resource = &Game->GetResourceCatalog()->ConsumerResources[ResourceIndex]->Data;
-			const struct ResourceVariation* Variation = &ThisSectorVariation->ResourceVariations[Resource];
-
 
 			float Consumption = Sector->GetPeople()->GetRessourceConsumption(Resource, false);
 			//FLOGV("%s comsumption = %f", *Resource->Name.ToString(), Consumption);
 
-			float ReserveStock =  Variation->ConsumerMaxStock / 10.f;
+			float ReserveStock =  ConsumerMaxStock / 10.f;
 			//FLOGV("ReserveStock = %f", ReserveStock);
 			if (Consumption < ReserveStock)
 			{
@@ -3137,20 +3423,19 @@ float UFlareCompanyAI::ComputeConstructionScoreForStation(UFlareSimulatedSector*
 	{
 		Score *= Behavior->MaintenanceAffility;
 
-		const SectorVariation* ThisSectorVariation = &WorldResourceVariation[Sector];
+		// Same maintenance capacity for every maintenance resource
+		int32 MaintenanceMaxStock = Game->GetGameWorld()->GetSectorStockCapacity(Sector).GetMaintenanceMaxStock(Company);
 
 		float MaxScoreModifier = 0;
 
 		for (int32 ResourceIndex = 0; ResourceIndex < Game->GetResourceCatalog()->MaintenanceResources.Num(); ResourceIndex++)
 		{
 			FFlareResourceDescription* Resource = &Game->GetResourceCatalog()->MaintenanceResources[ResourceIndex]->Data;
-			const struct ResourceVariation* Variation = &ThisSectorVariation->ResourceVariations[Resource];
-
 
 			int32 Consumption = WorldStats[Resource].Consumption / Company->GetKnownSectors().Num();
 			//FLOGV("%s comsumption = %d", *Resource->Name.ToString(), Consumption);
 
-			float ReserveStock =  Variation->MaintenanceMaxStock;
+			float ReserveStock =  MaintenanceMaxStock;
 			//FLOGV("ReserveStock = %f", ReserveStock);
 			if (Consumption < ReserveStock)
 			{
@@ -3177,69 +3462,38 @@ float UFlareCompanyAI::ComputeConstructionScoreForStation(UFlareSimulatedSector*
 	}
 	else if (FactoryDescription && FactoryDescription->IsResearch())
 	{
+		const WorldHelper::FlareFactoryScoreTerms& Terms = Game->GetGameWorld()->GetFactoryScoreTerms(Sector, FactoryDescription);
 
 		// Underflow malus
-		for (int32 ResourceIndex = 0; ResourceIndex < FactoryDescription->CycleCost.InputResources.Num(); ResourceIndex++)
+		if (!Terms.InputAvailable)
 		{
-			const FFlareFactoryResource* Resource = &FactoryDescription->CycleCost.InputResources[ResourceIndex];
-
-			float MaxVolume = FMath::Max(WorldStats[&Resource->Resource->Data].Production, WorldStats[&Resource->Resource->Data].Consumption);
-			if (MaxVolume > 0)
-			{
-				float UnderflowRatio = WorldStats[&Resource->Resource->Data].Balance / MaxVolume;
-				if (UnderflowRatio < 0)
-				{
-					float UnderflowMalus = FMath::Clamp((UnderflowRatio * 100)  / 20.f + 1.f, 0.f, 1.f);
-					Score *= UnderflowMalus;
-					//FLOGV("    MaxVolume %f", MaxVolume);
-					//FLOGV("    UnderflowRatio %f", UnderflowRatio);
-					//FLOGV("    UnderflowMalus %f", UnderflowMalus);
-				}
-			}
-			else
+			if(Technology)
 			{
-				if(Technology)
-				{
-					FLOG("No input production");
-				}
-				// No input production, ignore this station
-				return 0;
+				FLOG("No input production");
 			}
+			// No input production, ignore this station
+			return 0;
 		}
+		Score *= Terms.InputUnderflowMalus;
 
 		float StationPrice = ComputeStationPrice(Sector, StationDescription, Station);
 		Score *= 1.f + 1/StationPrice;
 	}
 	else if (FactoryDescription && FactoryDescription->IsShipyard())
 	{
+		const WorldHelper::FlareFactoryScoreTerms& Terms = Game->GetGameWorld()->GetFactoryScoreTerms(Sector, FactoryDescription);
+
 		Score *= Behavior->ShipyardAffility;
 
 		Score *= GetShipyardUsageRatio() * 0.5;
 
 		// Underflow malus
-		for (int32 ResourceIndex = 0; ResourceIndex < FactoryDescription->CycleCost.InputResources.Num(); ResourceIndex++)
+		if (!Terms.InputAvailable)
 		{
-			const FFlareFactoryResource* Resource = &FactoryDescription->CycleCost.InputResources[ResourceIndex];
-
-			float MaxVolume = FMath::Max(WorldStats[&Resource->Resource->Data].Production, WorldStats[&Resource->Resource->Data].Consumption);
-			if (MaxVolume > 0)
-			{
-				float UnderflowRatio = WorldStats[&Resource->Resource->Data].Balance / MaxVolume;
-				if (UnderflowRatio < 0)
-				{
-					float UnderflowMalus = FMath::Clamp((UnderflowRatio * 100)  / 20.f + 1.f, 0.f, 1.f);
-					Score *= UnderflowMalus;
-					//FLOGV("    MaxVolume %f", MaxVolume);
-					//FLOGV("    UnderflowRatio %f", UnderflowRatio);
-					//FLOGV("    UnderflowMalus %f", UnderflowMalus);
-				}
-			}
-			else
-			{
-				// No input production, ignore this station
-				return 0;
-			}
+			// No input production, ignore this station
+			return 0;
 		}
+		Score *= Terms.InputUnderflowMalus;
 
 		float StationPrice = ComputeStationPrice(Sector, StationDescription, Station);
 		Score *= 1.f + 1/StationPrice;
@@ -3249,42 +3503,15 @@ float UFlareCompanyAI::ComputeConstructionScoreForStation(UFlareSimulatedSector*
 	}
 	else if (FactoryDescription)
 	{
-		float GainPerCycle = 0;
-
-		GainPerCycle -= FactoryDescription->CycleCost.ProductionCost;
+		const WorldHelper::FlareFactoryScoreTerms& Terms = Game->GetGameWorld()->GetFactoryScoreTerms(Sector, FactoryDescription);
 
-
-
-		// Factory
-		for (int32 ResourceIndex = 0; ResourceIndex < FactoryDescription->CycleCost.InputResources.Num(); ResourceIndex++)
+		// Input underflow and prices
+		if (!Terms.InputAvailable)
 		{
-			const FFlareFactoryResource* Resource = &FactoryDescription->CycleCost.InputResources[ResourceIndex];
-			GainPerCycle -= Sector->GetResourcePrice(&Resource->Resource->Data, EFlareResourcePriceContext::FactoryInput) * Resource->Quantity;
-
-			float MaxVolume = FMath::Max(WorldStats[&Resource->Resource->Data].Production, WorldStats[&Resource->Resource->Data].Consumption);
-			if (MaxVolume > 0)
-			{
-				float UnderflowRatio = WorldStats[&Resource->Resource->Data].Balance / MaxVolume;
-				if (UnderflowRatio < 0)
-				{
-					float UnderflowMalus = FMath::Clamp((UnderflowRatio * 100)  / 20.f + 1.f, 0.f, 1.f);
-					Score *= UnderflowMalus;
-					//FLOGV("    MaxVolume %f", MaxVolume);
-					//FLOGV("    UnderflowRatio %f", UnderflowRatio);
-					//FLOGV("    UnderflowMalus %f", UnderflowMalus);
-				}
-			}
-			else
-			{
-				// No input production, ignore this station
-				return 0;
-			}
-
-			float ResourcePrice = Sector->GetPreciseResourcePrice(&Resource->Resource->Data);
-			float PriceRatio = (ResourcePrice - (float) Resource->Resource->Data.MinPrice) / (float) (Resource->Resource->Data.MaxPrice - Resource->Resource->Data.MinPrice);
-
-			Score *= (1 - PriceRatio) * 2;
+			// No input production, ignore this station
+			return 0;
 		}
+		Score *= Terms.InputUnderflowMalus * Terms.InputPriceScore;
 
 		//FLOGV(" after input: %f", Score);
 
@@ -3296,7 +3523,6 @@ float UFlareCompanyAI::ComputeConstructionScoreForStation(UFlareSimulatedSector*
 		for (int32 ResourceIndex = 0; ResourceIndex < FactoryDescription->CycleCost.OutputResources.Num(); ResourceIndex++)
 		{
 			const FFlareFactoryResource* Resource = &FactoryDescription->CycleCost.OutputResources[ResourceIndex];
-			GainPerCycle += Sector->GetResourcePrice(&Resource->Resource->Data, EFlareResourcePriceContext::FactoryOutput) * Resource->Quantity;
 
 			float ResourceAffility = Behavior->GetResourceAffility(&Resource->Resource->Data);
 			Score *= ResourceAffility;
@@ -3304,15 +3530,13 @@ float UFlareCompanyAI::ComputeConstructionScoreForStation(UFlareSimulatedSector*
 
 			//FLOGV(" ResourceAffility for %s: %f", *Resource->Resource->Data.Identifier.ToString(), ResourceAffility);
 
-			float MaxVolume = FMath::Max(WorldStats[&Resource->Resource->Data].Production, WorldStats[&Resource->Resource->Data].Consumption);
-			if (MaxVolume > 0)
+			if (Terms.OutputHasVolume[ResourceIndex])
 			{
-				float OverflowRatio = WorldStats[&Resource->Resource->Data].Balance / MaxVolume;
+				float OverflowRatio = Terms.OutputOverflowRatio[ResourceIndex];
 				if (OverflowRatio > 0)
 				{
 					float OverflowMalus = FMath::Clamp(1.f - ((OverflowRatio - 0.1f) * 100)  / ResourceAffility, 0.f, 1.f);
 					Score *= OverflowMalus;
-					//FLOGV("    MaxVolume %f", MaxVolume);
 					//FLOGV("    OverflowRatio %f", OverflowRatio);
 					//FLOGV("    OverflowMalus %f", OverflowMalus);
 				}
@@ -3322,14 +3546,7 @@ float UFlareCompanyAI::ComputeConstructionScoreForStation(UFlareSimulatedSector*
 				Score *= 1000;
 			}
 
-			float ResourcePrice = Sector->GetPreciseResourcePrice(&Resource->Resource->Data);
-			float PriceRatio = (ResourcePrice - (float) Resource->Resource->Data.MinPrice) / (float) (Resource->Resource->Data.MaxPrice - Resource->Resource->Data.MinPrice);
-
-
-			//FLOGV("    PriceRatio %f", PriceRatio);
-
-
-			Score *= PriceRatio * 2;
+			Score *= Terms.OutputPriceScore[ResourceIndex];
 		}
 
 		//FLOGV(" after output: %f", Score);
@@ -3340,7 +3557,7 @@ float UFlareCompanyAI::ComputeConstructionScoreForStation(UFlareSimulatedSector*
 			return 0;
 		}
 
-		float GainPerDay = GainPerCycle / FactoryDescription->CycleCost.ProductionTime;
+		float GainPerDay = Terms.GainPerCycle / FactoryDescription->CycleCost.ProductionTime;
 		if (GainPerDay < 0)
 		{
 			return 0;
@@ -15,6 +15,34 @@ struct FFlareDiplomacyStats
 
 };
 
+/** Company AI phases timed per company */
+namespace EFlareAIPhase
+{
+	enum Type
+	{
+		Simulate,
+		UpdateDiplomacy,
+		RepairAndRefill,
+		CargosEvasion,
+		ProcessBudgetMilitary,
+		ProcessBudgetTrade,
+		ProcessBudgetStation,
+		UpdateMilitaryMovement,
+		UpdateWarMilitaryMovement,
+		Count
+	};
+}
+
+/** Time and call count accumulated by an AI phase */
+struct AIPhaseStats
+{
+	double Seconds = 0;
+	int32 Calls = 0;
+
+	/** Calls that ran a reduced search because the company was over its time budget */
+	int32 DegradedCalls = 0;
+};
+
 struct AIWarContext
 {
 	TArray<UFlareCompany*> Allies;
@@ -22,6 +50,10 @@ struct AIWarContext
 	TArray<UFlareSimulatedSector*> KnownSectors;
 	float AttackThreshold;
 
+	/** Alliance and day this context was generated for, so allies can share it */
+	int32 AlliesCode = 0;
+	int64 Date = -1;
+
 	void Generate();
 };
 
@@ -52,6 +84,35 @@ struct DefenseSector
 	}
 };
 
+/** Ship chosen by FindBestShipToBuild, reused for the rest of the day */
+struct AIShipChoice
+{
+	const FFlareSpacecraftDescription* Description = nullptr;
+	int64 Date = -1;
+	int32 ShipCount = -1;
+};
+
+/** Company fleet statistics, built once per day in a single pass over the company spacecrafts */
+struct AIFleetStats
+{
+	int32 CargosCapacity = 0;
+	int32 DamagedCargosCapacity = 0;
+	int32 DamagedSpacecraftCount = 0;
+	TArray<UFlareSimulatedSpacecraft*> IncapacitatedCargos;
+	TArray<UFlareSimulatedSpacecraft*> IdleMilitaryShips;
+};
+
+/** Station construction or upgrade project, scored before the best one is picked */
+struct StationConstructionCandidate
+{
+	UFlareSimulatedSector* Sector;
+	FFlareSpacecraftDescription* StationDescription;
+	FFlareFactoryDescription* FactoryDescription;
+	UFlareSimulatedSpacecraft* Station;
+	bool ScoreComputed;
+	float Score;
+};
+
 
 UCLASS()
 class HELIUMRAIN_API UFlareCompanyAI : public UObject
@@ -84,6 +145,28 @@ public:
 
 	void UpdateIdleShipsStats(AITradeIdleShips& IdleShips);
 
+	/*----------------------------------------------------
+		Instrumentation
+	----------------------------------------------------*/
+
+	/** Add the duration of one call to an AI phase */
+	void AddPhaseTime(EFlareAIPhase::Type Phase, double Seconds);
+
+	void ResetPhaseStats();
+
+	const AIPhaseStats& GetPhaseStats(EFlareAIPhase::Type Phase) const
+	{
+		return PhaseStats[Phase];
+	}
+
+	static const TCHAR* GetPhaseName(EFlareAIPhase::Type Phase);
+
+	/** Check if the company has used its daily AI time budget, so expensive searches should be reduced */
+	bool IsOverTimeBudget() const;
+
+	/** Check the time budget before an expensive search of a phase, and count the phase call as degraded if over it */
+	bool UseDegradedSearch(EFlareAIPhase::Type Phase);
+
 	/*----------------------------------------------------
 		Behavior API
 	----------------------------------------------------*/
@@ -165,6 +248,9 @@ public:
 
 	bool HasHealthyTradeFleet() const;
 
+	/** Get the war context generated today for exactly these allies, if any */
+	const AIWarContext* FindDailyWarContext(int32 AlliesCode, const TArray<UFlareCompany*>& Allies) const;
+
 
 protected:
 
@@ -182,6 +268,9 @@ protected:
 
 	void AutoScrap();
 
+	/** Compute today's fleet statistics */
+	void UpdateFleetStats();
+
 	
 	/*----------------------------------------------------
 		Helpers
@@ -191,6 +280,9 @@ protected:
 	int64 OrderOneShip(const FFlareSpacecraftDescription* ShipDescription);
 
 	const FFlareSpacecraftDescription* FindBestShipToBuild(bool Military);
+
+	/** Get the catalog ships of a kind, sorted from small to large */
+	const TArray<const FFlareSpacecraftDescription*>& GetSortedShipCandidates(bool Military, bool LargeShip);
 	
 	/** Return if a ship is currently build for the company */
 	bool IsBuildingShip(bool Military);
@@ -199,14 +291,14 @@ protected:
 	TArray<UFlareSimulatedSpacecraft*> FindShipyards();
 
 	/** Get a list of wrecked cargos */
-	TArray<UFlareSimulatedSpacecraft*> FindIncapacitatedCargos() const;
+	const TArray<UFlareSimulatedSpacecraft*>& FindIncapacitatedCargos() const;
 	
-	int32 GetDamagedCargosCapacity();
+	int32 GetDamagedCargosCapacity() const;
 
-	int32 GetCargosCapacity();
+	int32 GetCargosCapacity() const;
 
 	/** Get a list of idle military */
-	TArray<UFlareSimulatedSpacecraft*> FindIdleMilitaryShips() const;
+	const TArray<UFlareSimulatedSpacecraft*>& FindIdleMilitaryShips() const;
 
 	float GetShipyardUsageRatio() const;
 
@@ -233,12 +325,21 @@ protected:
 	UFlareAIBehavior*                      Behavior;
 	
 	// Cache
-	TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats> WorldStats;
 	TArray<UFlareSimulatedSpacecraft*>       Shipyards;
-	TMap<UFlareSimulatedSector*, SectorVariation> WorldResourceVariation;
 
 	TArray<UFlareSimulatedSector*>            SectorWithBattle;
 
+	AIWarContext                              DailyWarContext;
+	AIFleetStats                              FleetStats;
+
+	AIShipChoice                              BestShipChoices[2];
+	TArray<const FFlareSpacecraftDescription*> SortedShipCandidates[4];
+	bool                                      SortedShipCandidatesValid;
+
+	// Instrumentation
+	AIPhaseStats                              PhaseStats[EFlareAIPhase::Count];
+	double                                    DayStartTime;
+
 	int32 IdleCargoCapacity;
 
 public:
@@ -10,6 +10,12 @@
 
 #include "../Player/FlarePlayerController.h"
 
+#include "../Spacecrafts/Subsystems/FlareSimulatedSpacecraftDamageSystem.h"
+#include "../Spacecrafts/Subsystems/FlareSimulatedSpacecraftWeaponsSystem.h"
+
+#define BATTLE_PREDICTION_MAX_TURNS 200
+#define BATTLE_PREDICTION_TARGET_SAMPLES 8
+
 
 struct BattleTargetPreferences
 {
@@ -769,4 +775,398 @@ int32 UFlareBattle::GetBestTargetComponent(UFlareSimulatedSpacecraft* TargetSpac
 }
 
 
+/*----------------------------------------------------
+	Battle prediction
+----------------------------------------------------*/
+
+void BattleFleetSummary::AddShip(UFlareSimulatedSpacecraft* Ship)
+{
+	BattleShipSummary Summary;
+	if (!BattlePredictor::SummarizeShip(Ship, Summary))
+	{
+		return;
+	}
+
+	CombatPoints += Summary.CombatPoints;
+
+	if (ShipCount < MaxShips)
+	{
+		Ships[ShipCount] = Summary;
+		ShipCount++;
+		return;
+	}
+
+	// Fleet full, merge the ship in the last slot
+	BattleShipSummary& Merged = Ships[MaxShips - 1];
+	Merged.CombatPoints += Summary.CombatPoints;
+	Merged.WeaponHitPoints += Summary.WeaponHitPoints;
+	Merged.RCSHitPoints += Summary.RCSHitPoints;
+	Merged.AmmoTurns = FMath::Max(Merged.AmmoTurns, Summary.AmmoTurns);
+
+	for (int32 TargetSize = 0; TargetSize < 2; TargetSize++)
+	{
+		Merged.AimedDamage[TargetSize] += Summary.AimedDamage[TargetSize];
+		Merged.HEATDamage[TargetSize] += Summary.HEATDamage[TargetSize];
+		Merged.RandomDamage[TargetSize] += Summary.RandomDamage[TargetSize];
+		Merged.Hits[TargetSize] += Summary.Hits[TargetSize];
+	}
+}
+
+bool BattlePredictor::SummarizeShip(UFlareSimulatedSpacecraft* Ship, BattleShipSummary& Summary)
+{
+	if (Ship->IsReserve() || !Ship->IsMilitary() || Ship->GetDamageSystem()->IsDisarmed())
+	{
+		return false;
+	}
+
+	UFlareSimulatedSpacecraftDamageSystem* DamageSystem = Ship->GetDamageSystem();
+	UFlareSimulatedSpacecraftWeaponsSystem* WeaponsSystem = Ship->GetWeaponsSystem();
+	UFlareSpacecraftComponentsCatalog* Catalog = Ship->GetGame()->GetShipPartsCatalog();
+
+	Summary = BattleShipSummary();
+	Summary.IsLarge = (Ship->GetSize() == EFlarePartSize::L);
+	Summary.CombatPoints = Ship->GetCombatPoints(true);
+	Summary.FireProbability = Summary.IsLarge ? 1.f : 0.8f;
+
+	// Component hit points and hit shares, with the armed target weights of GetBestTargetComponent
+	int32 ComponentCount = 0;
+	int32 WeaponCount = 0;
+	int32 RCSCount = 0;
+	float TotalWeight = 0;
+
+	for (FFlareSpacecraftComponentSave& ComponentData : Ship->GetData().Components)
+	{
+		FFlareSpacecraftComponentDescription* ComponentDescription = Catalog->Get(ComponentData.ComponentIdentifier);
+		if (!ComponentDescription)
+		{
+			continue;
+		}
+
+		ComponentCount++;
+
+		// Components are broken under the broken ratio
+		float UsableHitPoints = FMath::Max(0.f, DamageSystem->GetMaxHitPoints(ComponentDescription) * (1.f - BROKEN_RATIO) - ComponentData.Damage);
+
+		if (ComponentDescription->Type == EFlarePartType::Weapon)
+		{
+			Summary.WeaponHitPoints += UsableHitPoints;
+			Summary.WeaponArmor += UFlareSimulatedSpacecraftDamageSystem::GetArmor(ComponentDescription);
+			WeaponCount++;
+			TotalWeight += 20;
+		}
+		else if (ComponentDescription->Type == EFlarePartType::RCS)
+		{
+			Summary.RCSHitPoints += UsableHitPoints;
+			Summary.RCSArmor += UFlareSimulatedSpacecraftDamageSystem::GetArmor(ComponentDescription);
+			RCSCount++;
+			TotalWeight += 1;
+		}
+		else if (ComponentDescription->Type == EFlarePartType::OrbitalEngine)
+		{
+			TotalWeight += 8;
+		}
+		else if (ComponentDescription->Type == EFlarePartType::InternalComponent)
+		{
+			TotalWeight += 1;
+		}
+	}
+
+	if (WeaponCount == 0 || TotalWeight == 0)
+	{
+		return false;
+	}
+
+	Summary.WeaponArmor /= WeaponCount;
+	Summary.WeaponAimedShare = 20.f * WeaponCount / TotalWeight;
+	Summary.WeaponRandomShare = float(WeaponCount) / ComponentCount;
+
+	if (RCSCount > 0)
+	{
+		Summary.RCSArmor /= RCSCount;
+		Summary.RCSAimedShare = float(RCSCount) / TotalWeight;
+		Summary.RCSRandomShare = float(RCSCount) / ComponentCount;
+	}
+
+	// Firepower : large ships fire every turret, small ships fire their best weapon group
+	for (int32 GroupIndex = 0; GroupIndex < WeaponsSystem->GetWeaponGroupCount(); GroupIndex++)
+	{
+		FFlareSimulatedWeaponGroup* WeaponGroup = WeaponsSystem->GetWeaponGroup(GroupIndex);
+		FFlareSpacecraftComponentDescription* WeaponDescription = WeaponGroup->Description;
+		const FFlareSpacecraftComponentWeaponCharacteristics& Weapon = WeaponDescription->WeaponCharacteristics;
+
+		if (Summary.IsLarge && !Weapon.TurretCharacteristics.IsTurret)
+		{
+			continue;
+		}
+
+		float GroupAimedDamage[2] = { 0, 0 };
+		float GroupHEATDamage[2] = { 0, 0 };
+		float GroupRandomDamage[2] = { 0, 0 };
+		float GroupHits[2] = { 0, 0 };
+
+		for (FFlareSpacecraftComponentSave* WeaponData : WeaponGroup->Weapons)
+		{
+			float UsageRatio = DamageSystem->GetUsableRatio(WeaponDescription, WeaponData);
+			int32 CurrentAmmo = Weapon.AmmoCapacity - WeaponData->Weapon.FiredAmmo;
+
+			if (UsageRatio <= 0 || CurrentAmmo <= 0)
+			{
+				continue;
+			}
+
+			for (int32 TargetSize = 0; TargetSize < 2; TargetSize++)
+			{
+				if (Weapon.GunCharacteristics.IsGun)
+				{
+					// Same firing rules as SimulateShipWeaponAttack, with the average damage delay
+					float FiringPeriod = 1.f / (Weapon.GunCharacteristics.AmmoRate / 60.f);
+					float Delay = FiringPeriod * (1.f + 5.f * FMath::Square(1.f - UsageRatio));
+					float Shots = FMath::Min(float(CurrentAmmo), FMath::Max(1.f, FMath::FloorToFloat(5.f / Delay)));
+
+					float TargetCoef = (TargetSize == 0) ? 1.1f * 50 : 1.1f;
+					if (Weapon.FuzeType == EFlareShellFuzeType::Proximity)
+					{
+						TargetCoef /= 100;
+					}
+
+					float Hits = Shots * UsageRatio * FMath::Max(0.01f, 1.f - Weapon.GunCharacteristics.AmmoPrecision * TargetCoef);
+					GroupHits[TargetSize] += Hits;
+
+					if (Weapon.DamageType == EFlareShellDamageType::ArmorPiercing)
+					{
+						GroupAimedDamage[TargetSize] += Hits * Weapon.GunCharacteristics.KineticEnergy;
+					}
+					else if (Weapon.DamageType == EFlareShellDamageType::HEAT)
+					{
+						GroupHEATDamage[TargetSize] += Hits * Weapon.ExplosionPower;
+					}
+					else if (Weapon.DamageType == EFlareShellDamageType::HighExplosive)
+					{
+						// Average fragment hit ratio is 5.5%, average fragment power is 1
+						GroupRandomDamage[TargetSize] += Hits * Weapon.AmmoFragmentCount * 0.055f * Weapon.ExplosionPower;
+					}
+
+					if (TargetSize == 1)
+					{
+						Summary.AmmoTurns = FMath::Max(Summary.AmmoTurns, FMath::CeilToInt(CurrentAmmo / Shots));
+					}
+				}
+				else if (Weapon.BombCharacteristics.IsBomb)
+				{
+					// One bomb per turn, always a hit
+					GroupHits[TargetSize] += 1;
+
+					if (SpacecraftHelper::GetWeaponDamageType(Weapon.DamageType) == EFlareDamage::DAM_HEAT)
+					{
+						GroupHEATDamage[TargetSize] += Weapon.ExplosionPower;
+					}
+					else
+					{
+						GroupAimedDamage[TargetSize] += Weapon.ExplosionPower;
+					}
+
+					if (TargetSize == 1)
+					{
+						Summary.AmmoTurns = FMath::Max(Summary.AmmoTurns, CurrentAmmo);
+					}
+				}
+			}
+		}
+
+		for (int32 TargetSize = 0; TargetSize < 2; TargetSize++)
+		{
+			float GroupDamage = GroupAimedDamage[TargetSize] + GroupHEATDamage[TargetSize] + GroupRandomDamage[TargetSize];
+			float CurrentDamage = Summary.AimedDamage[TargetSize] + Summary.HEATDamage[TargetSize] + Summary.RandomDamage[TargetSize];
+
+			if (Summary.IsLarge)
+			{
+				Summary.AimedDamage[TargetSize] += GroupAimedDamage[TargetSize];
+				Summary.HEATDamage[TargetSize] += GroupHEATDamage[TargetSize];
+				Summary.RandomDamage[TargetSize] += GroupRandomDamage[TargetSize];
+				Summary.Hits[TargetSize] += GroupHits[TargetSize];
+				Summary.Preference[TargetSize] += (TargetSize == 0) ? Weapon.AntiSmallShipValue : Weapon.AntiLargeShipValue;
+			}
+			else if (GroupDamage > CurrentDamage)
+			{
+				Summary.AimedDamage[TargetSize] = GroupAimedDamage[TargetSize];
+				Summary.HEATDamage[TargetSize] = GroupHEATDamage[TargetSize];
+				Summary.RandomDamage[TargetSize] = GroupRandomDamage[TargetSize];
+				Summary.Hits[TargetSize] = GroupHits[TargetSize];
+			}
+		}
+	}
+
+	if (!Summary.IsLarge)
+	{
+		float Unused = 0;
+		WeaponsSystem->GetTargetPreference(&Summary.Preference[0], &Summary.Preference[1], &Unused, &Unused, &Unused, &Unused, &Unused, &Unused);
+	}
+
+	return true;
+}
+
+BattlePrediction BattlePredictor::Predict(const BattleFleetSummary& Attackers, const BattleFleetSummary& Defenders, int32 TrialCount, int32 Seed)
+{
+	const int32 MaxShips = BattleFleetSummary::MaxShips;
+	const BattleFleetSummary* Fleets[2] = { &Attackers, &Defenders };
+
+	BattlePrediction Prediction;
+
+	if (Attackers.ShipCount == 0 || Defenders.ShipCount == 0)
+	{
+		Prediction.WinProbability = (Defenders.ShipCount == 0 && Attackers.ShipCount > 0) ? 1.f : 0.f;
+		return Prediction;
+	}
+
+	// Trial state, kept on the stack
+	float WeaponHitPoints[2][MaxShips];
+	float RCSHitPoints[2][MaxShips];
+	int32 AmmoTurns[2][MaxShips];
+	int32 ArmedShips[2][MaxShips];
+	int32 ArmedPositions[2][MaxShips];
+	int32 ArmedCount[2];
+
+	FRandomStream RandomStream(Seed);
+	TrialCount = FMath::Max(1, TrialCount);
+
+	int32 Wins = 0;
+	int64 TotalTurns = 0;
+	float TotalLosses[2] = { 0, 0 };
+
+	for (int32 TrialIndex = 0; TrialIndex < TrialCount; TrialIndex++)
+	{
+		for (int32 Side = 0; Side < 2; Side++)
+		{
+			const BattleFleetSummary* Fleet = Fleets[Side];
+			ArmedCount[Side] = Fleet->ShipCount;
+
+			for (int32 ShipIndex = 0; ShipIndex < Fleet->ShipCount; ShipIndex++)
+			{
+				WeaponHitPoints[Side][ShipIndex] = Fleet->Ships[ShipIndex].WeaponHitPoints;
+				RCSHitPoints[Side][ShipIndex] = Fleet->Ships[ShipIndex].RCSHitPoints;
+				AmmoTurns[Side][ShipIndex] = Fleet->Ships[ShipIndex].AmmoTurns;
+				ArmedShips[Side][ShipIndex] = ShipIndex;
+				ArmedPositions[Side][ShipIndex] = ShipIndex;
+			}
+		}
+
+		float Losses[2] = { 0, 0 };
+		int32 Turn = 0;
+
+		while (ArmedCount[0] > 0 && ArmedCount[1] > 0 && Turn < BATTLE_PREDICTION_MAX_TURNS)
+		{
+			Turn++;
+			bool HasFight = false;
+
+			// Interleave both sides, starting from a random one
+			int32 FirstSide = RandomStream.RandRange(0, 1);
+			int32 MaxShipCount = FMath::Max(Attackers.ShipCount, Defenders.ShipCount);
+
+			for (int32 ShipIndex = 0; ShipIndex < MaxShipCount; ShipIndex++)
+			{
+				for (int32 SideIndex = 0; SideIndex < 2; SideIndex++)
+				{
+					int32 Side = (FirstSide + SideIndex) % 2;
+					int32 EnemySide = 1 - Side;
+					const BattleFleetSummary* Fleet = Fleets[Side];
+
+					if (ShipIndex >= Fleet->ShipCount
+					 || ArmedPositions[Side][ShipIndex] < 0
+					 || AmmoTurns[Side][ShipIndex] <= 0
+					 || ArmedCount[EnemySide] == 0)
+					{
+						continue;
+					}
+
+					const BattleShipSummary& Ship = Fleet->Ships[ShipIndex];
+					HasFight = true;
+					AmmoTurns[Side][ShipIndex]--;
+
+					if (RandomStream.FRand() >= Ship.FireProbability)
+					{
+						continue;
+					}
+
+					// Pick the best target among a few armed enemies, like GetBestTarget
+					int32 TargetIndex = -1;
+					float BestScore = 0;
+					int32 SampleCount = FMath::Min(ArmedCount[EnemySide], BATTLE_PREDICTION_TARGET_SAMPLES);
+
+					for (int32 SampleIndex = 0; SampleIndex < SampleCount; SampleIndex++)
+					{
+						int32 CandidateIndex = ArmedShips[EnemySide][RandomStream.RandRange(0, ArmedCount[EnemySide] - 1)];
+						const BattleShipSummary& Candidate = Fleets[EnemySide]->Ships[CandidateIndex];
+						float Score = Ship.Preference[Candidate.IsLarge ? 1 : 0] * RandomStream.FRand();
+
+						if (Score > BestScore)
+						{
+							TargetIndex = CandidateIndex;
+							BestScore = Score;
+						}
+					}
+
+					if (TargetIndex < 0)
+					{
+						continue;
+					}
+
+					// Damage the target weapons and RCS, with a firepower reduced by the shooter damages
+					const BattleShipSummary& Target = Fleets[EnemySide]->Ships[TargetIndex];
+					int32 TargetSize = Target.IsLarge ? 1 : 0;
+					float UsageRatio = (Ship.WeaponHitPoints > 0) ? WeaponHitPoints[Side][ShipIndex] / Ship.WeaponHitPoints : 0;
+					float Variation = FMath::Max(0.f, 1.f + (2.f * RandomStream.FRand() - 1.f) * 1.732f / FMath::Sqrt(FMath::Max(1.f, Ship.Hits[TargetSize])));
+					float Scale = UsageRatio * Variation;
+
+					float AimedDamage = Ship.AimedDamage[TargetSize] * Scale;
+					float HEATDamage = Ship.HEATDamage[TargetSize] * Scale;
+					float RandomDamage = Ship.RandomDamage[TargetSize] * Scale;
+
+					WeaponHitPoints[EnemySide][TargetIndex] -= (AimedDamage * (1.f - Target.WeaponArmor) + HEATDamage) * Target.WeaponAimedShare
+						+ RandomDamage * (1.f - Target.WeaponArmor) * Target.WeaponRandomShare;
+					RCSHitPoints[EnemySide][TargetIndex] -= (AimedDamage * (1.f - Target.RCSArmor) + HEATDamage) * Target.RCSAimedShare
+						+ RandomDamage * (1.f - Target.RCSArmor) * Target.RCSRandomShare;
+
+					// Broken weapons, or broken RCS for small ships, take the ship out of the fight
+					if (WeaponHitPoints[EnemySide][TargetIndex] <= 0
+					 || (!Target.IsLarge && Target.RCSAimedShare > 0 && RCSHitPoints[EnemySide][TargetIndex] <= 0))
+					{
+						int32 Position = ArmedPositions[EnemySide][TargetIndex];
+						int32 LastShipIndex = ArmedShips[EnemySide][ArmedCount[EnemySide] - 1];
+
+						ArmedShips[EnemySide][Position] = LastShipIndex;
+						ArmedPositions[EnemySide][LastShipIndex] = Position;
+						ArmedPositions[EnemySide][TargetIndex] = -1;
+						ArmedCount[EnemySide]--;
+
+						Losses[EnemySide] += Target.CombatPoints;
+					}
+				}
+			}
+
+			if (!HasFight)
+			{
+				// Nobody can fight
+				break;
+			}
+		}
+
+		if (ArmedCount[1] == 0 && ArmedCount[0] > 0)
+		{
+			Wins++;
+		}
+
+		TotalTurns += Turn;
+		TotalLosses[0] += Losses[0];
+		TotalLosses[1] += Losses[1];
+	}
+
+	Prediction.WinProbability = float(Wins) / TrialCount;
+	Prediction.AttackerExpectedLosses = TotalLosses[0] / TrialCount;
+	Prediction.DefenderExpectedLosses = TotalLosses[1] / TrialCount;
+	Prediction.ExpectedTurns = float(TotalTurns) / TrialCount;
+
+	return Prediction;
+}
+
+
 #undef LOCTEXT_NAMESPACE
@@ -7,6 +7,75 @@
 class UFlareSpacecraftComponentsCatalog;
 
 
+/** Compact state of one armed ship, as seen by the battle predictor */
+struct BattleShipSummary
+{
+	bool IsLarge = false;
+	int32 CombatPoints = 0;
+
+	/** Hit points left before the weapons, or the RCS of a small ship, are broken */
+	float WeaponHitPoints = 0;
+	float RCSHitPoints = 0;
+
+	/** Average armor of the weapons and RCS */
+	float WeaponArmor = 0;
+	float RCSArmor = 0;
+
+	/** Share of aimed and random hits landing on the weapons and RCS */
+	float WeaponAimedShare = 0;
+	float WeaponRandomShare = 0;
+	float RCSAimedShare = 0;
+	float RCSRandomShare = 0;
+
+	/** Expected damage per turn against small and large ships : aimed, aimed ignoring armor, and on random components */
+	float AimedDamage[2] = { 0, 0 };
+	float HEATDamage[2] = { 0, 0 };
+	float RandomDamage[2] = { 0, 0 };
+
+	/** Expected hits per turn against small and large ships, used for the trial variance */
+	float Hits[2] = { 0, 0 };
+
+	/** Targeting preferences against small and large ships */
+	float Preference[2] = { 0, 0 };
+
+	/** Probability to fire each turn, and turns of ammo left */
+	float FireProbability = 1.f;
+	int32 AmmoTurns = 0;
+};
+
+/** Fixed capacity fleet summary : ships over capacity are merged in the last slot */
+struct BattleFleetSummary
+{
+	static const int32 MaxShips = 64;
+
+	BattleShipSummary Ships[MaxShips];
+	int32 ShipCount = 0;
+	int32 CombatPoints = 0;
+
+	/** Add an armed military ship to the fleet */
+	void AddShip(UFlareSimulatedSpacecraft* Ship);
+};
+
+/** Result of a battle prediction, from the attacker point of view */
+struct BattlePrediction
+{
+	float WinProbability = 0;
+	float AttackerExpectedLosses = 0;
+	float DefenderExpectedLosses = 0;
+	float ExpectedTurns = 0;
+};
+
+/** Monte Carlo battle estimator following the UFlareBattle rules on fleet summaries */
+struct BattlePredictor
+{
+	/** Build the summary of one ship, return false if the ship can't fight */
+	static bool SummarizeShip(UFlareSimulatedSpacecraft* Ship, BattleShipSummary& Summary);
+
+	/** Run seeded battle trials, without allocation */
+	static BattlePrediction Predict(const BattleFleetSummary& Attackers, const BattleFleetSummary& Defenders, int32 TrialCount, int32 Seed);
+};
+
+
 UCLASS()
 class HELIUMRAIN_API UFlareBattle : public UObject
 {
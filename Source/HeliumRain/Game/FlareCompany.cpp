@@ -32,6 +32,7 @@
 UFlareCompany::UFlareCompany(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
+	FMemory::Memzero(CompanyValueTotals);
 }
 
 
@@ -65,6 +66,8 @@ void UFlareCompany::Load(const FFlareCompanySave& Data)
 	TacticManager->Load(this);
 
 	// Load technologies
+	UnlockedTechnologies.Empty();
+	UnlockedTechnologyBits.Init(false, GetGame()->GetTechnologyCatalog()->TechnologyCatalog.Num());
 	for (int i = 0; i < CompanyData.UnlockedTechnologies.Num(); i++)
 	{
 		UnlockTechnology(CompanyData.UnlockedTechnologies[i], true);
@@ -102,14 +105,14 @@ void UFlareCompany::Load(const FFlareCompanySave& Data)
 
 	// Load emblem
 	SetupEmblem();
-
-	InvalidateCompanyValueCache();
 }
 
 void UFlareCompany::PostLoad()
 {
 	VisitedSectors.Empty();
 	KnownSectors.Empty();
+	VisitedSectorBits.Empty();
+	KnownSectorBits.Empty();
 	CompanyTradeRoutes.Empty();
 
 	// Load all trade routes
@@ -127,9 +130,11 @@ void UFlareCompany::PostLoad()
 			switch (CompanyData.SectorsKnowledge[i].Knowledge) {
 			case EFlareSectorKnowledge::Visited:
 				VisitedSectors.Add(Sector);
+				SetIndexBit(VisitedSectorBits, Sector->GetSectorIndex());
 				// No break
 			case EFlareSectorKnowledge::Known:
 				KnownSectors.Add(Sector);
+				SetIndexBit(KnownSectorBits, Sector->GetSectorIndex());
 				break;
 			default:
 				break;
@@ -397,6 +402,11 @@ void UFlareCompany::SetHostilityTo(UFlareCompany* TargetCompany, bool Hostile)
 				Game->GetQuestManager()->OnWarStateChanged(this, TargetCompany);
 			}
 		}
+
+		if (Hostile != WasHostile && Game->GetGameWorld())
+		{
+			Game->GetGameWorld()->InvalidateIncomingPlayerEnemy();
+		}
 	}
 }
 
@@ -677,20 +687,40 @@ void UFlareCompany::DestroySpacecraft(UFlareSimulatedSpacecraft* Spacecraft)
 	}
 	GetGame()->GetGameWorld()->ClearFactories(Spacecraft);
 	CompanyAI->DestroySpacecraft(Spacecraft);
+	RemoveSpacecraftValue(Spacecraft);
+	GetGame()->GetGameWorld()->RemoveCaptureCandidate(Spacecraft);
+	GetGame()->GetGameWorld()->RemoveShipyard(Spacecraft);
 	Spacecraft->SetDestroyed(true);
 
+	if (IsPlayerCompany())
+	{
+		GetGame()->GetGameWorld()->InvalidateIncomingPlayerEnemy();
+	}
+
 	CompanyDestroyedSpacecrafts.Add(Spacecraft);
 }
 
 void UFlareCompany::DiscoverSector(UFlareSimulatedSector* Sector)
 {
-	KnownSectors.AddUnique(Sector);
+	if (!IsKnownSector(Sector))
+	{
+		KnownSectors.Add(Sector);
+		SetIndexBit(KnownSectorBits, Sector->GetSectorIndex());
+	}
 }
 
 void UFlareCompany::VisitSector(UFlareSimulatedSector* Sector)
 {
 	DiscoverSector(Sector);
-	VisitedSectors.AddUnique(Sector);
+	if (Sector->GetSectorIndex() == INDEX_NONE)
+	{
+		VisitedSectors.AddUnique(Sector);
+	}
+	else if (!HasIndexBit(VisitedSectorBits, Sector->GetSectorIndex()))
+	{
+		VisitedSectors.Add(Sector);
+		SetIndexBit(VisitedSectorBits, Sector->GetSectorIndex());
+	}
 	if (GetGame()->GetQuestManager())
 	{
 		GetGame()->GetQuestManager()->OnSectorVisited(Sector);
@@ -721,8 +751,6 @@ bool UFlareCompany::TakeMoney(int64 Amount, bool AllowDepts, FFlareTransactionLo
 			CompanyData.TransactionLog.Push(TransactionContext);
 		}
 
-		InvalidateCompanyValueCache();
-
 		return true;
 	}
 }
@@ -750,14 +778,39 @@ void UFlareCompany::GiveMoney(int64 Amount, FFlareTransactionLogEntry Transactio
 		CompanyData.TransactionLog.Push(TransactionContext);
 	}
 
-	InvalidateCompanyValueCache();
-
 	/*if (Amount > 0)
 	{
 		FLOGV("$ %s + %lld -> %llu", *GetCompanyName().ToString(), Amount, CompanyData.Money);
 	}*/
 }
 
+void UFlareCompany::GiveMoney(int64 Amount, const TArray<FFlareTransactionLogEntry>& Transactions)
+{
+	if (Amount < 0)
+	{
+		FLOGV("UFlareCompany::GiveMoney : Failed to give %f money from %s (balance: %f)",
+			Amount/100., *GetCompanyName().ToString(), CompanyData.Money/100.);
+		return;
+	}
+
+	CompanyData.Money += Amount;
+
+	if (this == Game->GetPC()->GetCompany())
+	{
+		if (GetGame()->GetQuestManager())
+		{
+			GetGame()->GetQuestManager()->OnEvent(FFlareBundle().PutTag("gain-money").PutInt32("amount", Amount));
+		}
+
+		int64 Date = GetGame()->GetGameWorld()->GetDate();
+		for (const FFlareTransactionLogEntry& Transaction : Transactions)
+		{
+			CompanyData.TransactionLog.Push(Transaction);
+			CompanyData.TransactionLog.Last().Date = Date;
+		}
+	}
+}
+
 void UFlareCompany::GiveResearch(int64 Amount)
 {
 	if (Amount < 0)
@@ -1181,6 +1234,7 @@ void UFlareCompany::StartCapture(UFlareSimulatedSpacecraft* Station)
 	}
 
 	CompanyData.CaptureOrders.AddUnique(Station->GetImmatriculation());
+	Game->GetGameWorld()->AddCaptureCandidate(Station);
 }
 
 void UFlareCompany::StopCapture(UFlareSimulatedSpacecraft* Station)
@@ -1282,9 +1336,23 @@ const FSlateBrush* UFlareCompany::GetEmblem() const
 	Technology
 ----------------------------------------------------*/
 
+void UFlareCompany::SetIndexBit(TBitArray<>& Bits, int32 Index)
+{
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	while (Bits.Num() <= Index)
+	{
+		Bits.Add(false);
+	}
+	Bits[Index] = true;
+}
+
 bool UFlareCompany::IsTechnologyUnlocked(FName Identifier) const
 {
-	if (UnlockedTechnologies.Contains(Identifier))
+	if (IsTechnologyIndexUnlocked(GetGame()->GetTechnologyCatalog()->GetTechnologyIndex(Identifier)))
 	{
 		return true;
 	}
@@ -1460,6 +1528,7 @@ void UFlareCompany::UnlockTechnology(FName Identifier, bool FromSave, bool Force
 
 		// Unlock
 		UnlockedTechnologies.Add(Identifier, Technology);
+		SetIndexBit(UnlockedTechnologyBits, GetGame()->GetTechnologyCatalog()->GetTechnologyIndex(Identifier));
 
 		if (!FromSave)
 		{
@@ -1484,6 +1553,9 @@ void UFlareCompany::UnlockTechnology(FName Identifier, bool FromSave, bool Force
 					false);
 				GetGame()->GetQuestManager()->OnEvent(FFlareBundle().PutTag("unlock-technology").PutName("technology", Identifier).PutInt32("level", Technology->Level));
 
+				// Early warning and radar technologies change the threat reports
+				GetGame()->GetGameWorld()->InvalidateIncomingPlayerEnemy();
+
 				GetGame()->GetPC()->SetAchievementProgression("ACHIEVEMENT_ONE_TECHNOLOGY", 1);
 				if(UnlockedTechnologies.Num() >= GetGame()->GetTechnologyCatalog()->TechnologyCatalog.Num())
 				{
@@ -1498,21 +1570,79 @@ void UFlareCompany::UnlockTechnology(FName Identifier, bool FromSave, bool Force
 
 
 /*----------------------------------------------------
-	Getters
+	Payment batch
 ----------------------------------------------------*/
 
-
-const struct CompanyValue UFlareCompany::GetCompanyValue(UFlareSimulatedSector* SectorFilter, bool IncludeIncoming) const
+void CompanyPaymentBatch::Add(UFlareCompany* Company, int64 Amount, const FFlareTransactionLogEntry& TransactionContext)
 {
-	bool globalRequest = SectorFilter == nullptr;
+	CompanyPayments* Entry = Payments.FindByPredicate([Company](const CompanyPayments& Candidate)
+	{
+		return Candidate.Company == Company;
+	});
+
+	if (!Entry)
+	{
+		Entry = &Payments[Payments.AddDefaulted()];
+		Entry->Company = Company;
+		Entry->Amount = 0;
+	}
+
+	Entry->Amount += Amount;
+
+	// Same transaction on the same spacecraft and resource, only the quantity differs
+	FFlareTransactionLogEntry* Transaction = Entry->Transactions.FindByPredicate([&TransactionContext](const FFlareTransactionLogEntry& Candidate)
+	{
+		return Candidate.Type == TransactionContext.Type
+			&& Candidate.Spacecraft == TransactionContext.Spacecraft
+			&& Candidate.Sector == TransactionContext.Sector
+			&& Candidate.OtherCompany == TransactionContext.OtherCompany
+			&& Candidate.OtherSpacecraft == TransactionContext.OtherSpacecraft
+			&& Candidate.Resource == TransactionContext.Resource
+			&& Candidate.ExtraIdentifier1 == TransactionContext.ExtraIdentifier1
+			&& Candidate.ExtraIdentifier2 == TransactionContext.ExtraIdentifier2;
+	});
 
+	if (Transaction)
+	{
+		Transaction->Amount += Amount;
+		Transaction->ResourceQuantity += TransactionContext.ResourceQuantity;
+	}
+	else
+	{
+		Entry->Transactions.Add(TransactionContext);
+		Entry->Transactions.Last().Amount = Amount;
+	}
+}
 
-	if(CompanyValueCacheValid && globalRequest)
+void CompanyPaymentBatch::Apply()
+{
+	for (CompanyPayments& Entry : Payments)
 	{
-		return CompanyValueCache;
+		Entry.Company->GiveMoney(Entry.Amount, Entry.Transactions);
 	}
 
+	Payments.Empty();
+}
+
+
+/*----------------------------------------------------
+	Getters
+----------------------------------------------------*/
+
+
+static void AddCompanyValue(struct CompanyValue& Target, const struct CompanyValue& Source, int64 Sign)
+{
+	Target.StockValue += Sign * Source.StockValue;
+	Target.ShipsValue += Sign * Source.ShipsValue;
+	Target.ArmyValue += Sign * Source.ArmyValue;
+	Target.ArmyTotalCombatPoints += Sign * Source.ArmyTotalCombatPoints;
+	Target.ArmyCurrentCombatPoints += Sign * Source.ArmyCurrentCombatPoints;
+	Target.StationsValue += Sign * Source.StationsValue;
+}
 
+const struct CompanyValue UFlareCompany::GetCompanyValue(UFlareSimulatedSector* SectorFilter, bool IncludeIncoming) const
+{
+	UpdateCompanyValue();
 
 	// Company value is the sum of :
 	// - money
@@ -1528,121 +1658,228 @@ const struct CompanyValue UFlareCompany::GetCompanyValue(UFlareSimulatedSector*
 	CompanyValue.ArmyTotalCombatPoints = 0;
 	CompanyValue.StationsValue = 0;
 
-	for (int SpacecraftIndex = 0; SpacecraftIndex < CompanySpacecrafts.Num(); SpacecraftIndex++)
+	if (SectorFilter)
+	{
+		for (auto& Entry : SpacecraftValues)
+		{
+			const SpacecraftValue& Value = Entry.Value;
+
+			if (Value.ReferenceSector != SectorFilter || (Value.Incoming && !IncludeIncoming))
+			{
+				// Not in sector filter
+				continue;
+			}
+
+			AddCompanyValue(CompanyValue, Value.Value, 1);
+		}
+	}
+	else
+	{
+		AddCompanyValue(CompanyValue, CompanyValueTotals, 1);
+	}
+
+	CompanyValue.SpacecraftsValue = CompanyValue.ShipsValue + CompanyValue.StationsValue;
+	CompanyValue.TotalValue = CompanyValue.MoneyValue + CompanyValue.StockValue + CompanyValue.SpacecraftsValue;
+
+	return CompanyValue;
+}
+
+void UFlareCompany::InvalidateSpacecraftValue(UFlareSimulatedSpacecraft* Spacecraft)
+{
+	// Complex elements are valued through their complex master
+	if (Spacecraft->IsComplexElement())
+	{
+		if (Spacecraft->GetComplexMaster())
+		{
+			DirtySpacecraftValues.Add(Spacecraft->GetComplexMaster());
+		}
+		return;
+	}
+
+	DirtySpacecraftValues.Add(Spacecraft);
+}
+
+void UFlareCompany::RemoveSpacecraftValue(UFlareSimulatedSpacecraft* Spacecraft)
+{
+	SpacecraftValue* Value = SpacecraftValues.Find(Spacecraft);
+	if (Value)
 	{
-		UFlareSimulatedSpacecraft* Spacecraft = CompanySpacecrafts[SpacecraftIndex];
+		AddCompanyValue(CompanyValueTotals, Value->Value, -1);
+		SpacecraftValues.Remove(Spacecraft);
+	}
 
-		UFlareSimulatedSector *ReferenceSector =  Spacecraft->GetCurrentSector();
+	DirtySpacecraftValues.Remove(Spacecraft);
+}
 
-		if(SectorFilter && !IncludeIncoming && SectorFilter != ReferenceSector)
+void UFlareCompany::UpdateCompanyValuePrices()
+{
+	for (auto& Entry : SpacecraftValues)
+	{
+		UFlareSimulatedSector* ReferenceSector = Entry.Value.ReferenceSector;
+		if (!ReferenceSector || ReferenceSector->GetChangedPriceResources().Num() == 0)
 		{
-			// Not in sector filter
 			continue;
 		}
 
-		if (!ReferenceSector)
+		for (FFlareResourceDescription* Resource : ReferenceSector->GetChangedPriceResources())
 		{
-			if (Spacecraft->GetCurrentFleet() && Spacecraft->GetCurrentFleet()->GetCurrentTravel())
-			{
-				ReferenceSector = Spacecraft->GetCurrentFleet()->GetCurrentTravel()->GetDestinationSector();
-			}
-			else
+			if (Entry.Value.ValuedResources.Contains(Resource))
 			{
-				FLOGV("Spacecraft %s is lost : no current sector, no travel", *Spacecraft->GetImmatriculation().ToString());
-				continue;
+				DirtySpacecraftValues.Add(Entry.Key);
+				break;
 			}
+		}
+	}
+}
+
+void UFlareCompany::UpdateCompanyValue() const
+{
+	if (DirtySpacecraftValues.Num() == 0)
+	{
+		return;
+	}
 
+	for (UFlareSimulatedSpacecraft* Spacecraft : DirtySpacecraftValues)
+	{
+		SpacecraftValue* OldValue = SpacecraftValues.Find(Spacecraft);
+		if (OldValue)
+		{
+			AddCompanyValue(CompanyValueTotals, OldValue->Value, -1);
+			SpacecraftValues.Remove(Spacecraft);
 		}
 
-		if(SectorFilter && IncludeIncoming && SectorFilter != ReferenceSector)
+		if (Spacecraft->IsDestroyed() || Spacecraft->GetCompany() != this)
 		{
-			// Not in sector filter
 			continue;
 		}
 
-		// Value of the spacecraft
-		int64 SpacecraftPrice = UFlareGameTools::ComputeSpacecraftPrice(Spacecraft->GetDescription()->Identifier, ReferenceSector, true);
+		SpacecraftValue NewValue;
+		if (ComputeSpacecraftValue(Spacecraft, NewValue))
+		{
+			AddCompanyValue(CompanyValueTotals, NewValue.Value, 1);
+			SpacecraftValues.Add(Spacecraft, NewValue);
+		}
+	}
+
+	DirtySpacecraftValues.Empty();
+}
+
+bool UFlareCompany::ComputeSpacecraftValue(UFlareSimulatedSpacecraft* Spacecraft, SpacecraftValue& OutValue) const
+{
+	UFlareSimulatedSector *ReferenceSector =  Spacecraft->GetCurrentSector();
+	OutValue.Incoming = false;
 
-		if(Spacecraft->IsStation())
+	if (!ReferenceSector)
+	{
+		if (Spacecraft->GetCurrentFleet() && Spacecraft->GetCurrentFleet()->GetCurrentTravel())
 		{
-			CompanyValue.StationsValue += SpacecraftPrice * Spacecraft->GetLevel();
+			ReferenceSector = Spacecraft->GetCurrentFleet()->GetCurrentTravel()->GetDestinationSector();
+			OutValue.Incoming = true;
 		}
 		else
 		{
-			CompanyValue.ShipsValue += SpacecraftPrice;
+			FLOGV("Spacecraft %s is lost : no current sector, no travel", *Spacecraft->GetImmatriculation().ToString());
+			return false;
 		}
+	}
+
+	OutValue.ReferenceSector = ReferenceSector;
+	OutValue.ValuedResources.Empty();
+
+	CompanyValue& Value = OutValue.Value;
+	Value.MoneyValue = 0;
+	Value.StockValue = 0;
+	Value.ShipsValue = 0;
+	Value.ArmyValue = 0;
+	Value.ArmyCurrentCombatPoints = 0;
+	Value.ArmyTotalCombatPoints = 0;
+	Value.StationsValue = 0;
+
+	// Value of the spacecraft
+	int64 SpacecraftPrice = UFlareGameTools::ComputeSpacecraftPrice(Spacecraft->GetDescription()->Identifier, ReferenceSector, true);
+
+	for (const FFlareFactoryResource& Resource : Spacecraft->GetDescription()->CycleCost.InputResources)
+	{
+		OutValue.ValuedResources.AddUnique(&Resource.Resource->Data);
+	}
+	for (const FFlareFactoryResource& Resource : Spacecraft->GetDescription()->CycleCost.OutputResources)
+	{
+		OutValue.ValuedResources.AddUnique(&Resource.Resource->Data);
+	}
+
+	if(Spacecraft->IsStation())
+	{
+		Value.StationsValue += SpacecraftPrice * Spacecraft->GetLevel();
+	}
+	else
+	{
+		Value.ShipsValue += SpacecraftPrice;
+	}
+
+	if(Spacecraft->IsMilitary())
+	{
+		Value.ArmyValue += SpacecraftPrice;
+		Value.ArmyTotalCombatPoints += Spacecraft->GetCombatPoints(false);
+		Value.ArmyCurrentCombatPoints += Spacecraft->GetCombatPoints(true);
+	}
+
+	// Value of the stock
+	{
+	TArray<FFlareCargo>& CargoBaySlots = Spacecraft->GetProductionCargoBay()->GetSlots();
+	for (int CargoIndex = 0; CargoIndex < CargoBaySlots.Num(); CargoIndex++)
+	{
+		FFlareCargo& Cargo = CargoBaySlots[CargoIndex];
 
-		if(Spacecraft->IsMilitary())
+		if (!Cargo.Resource)
 		{
-			CompanyValue.ArmyValue += SpacecraftPrice;
-			CompanyValue.ArmyTotalCombatPoints += Spacecraft->GetCombatPoints(false);
-			CompanyValue.ArmyCurrentCombatPoints += Spacecraft->GetCombatPoints(true);
+			continue;
 		}
 
-		// Value of the stock
-		{
-		TArray<FFlareCargo>& CargoBaySlots = Spacecraft->GetProductionCargoBay()->GetSlots();
-		for (int CargoIndex = 0; CargoIndex < CargoBaySlots.Num(); CargoIndex++)
-		{
-			FFlareCargo& Cargo = CargoBaySlots[CargoIndex];
+		Value.StockValue += ReferenceSector->GetResourcePrice(Cargo.Resource, EFlareResourcePriceContext::Default) * Cargo.Quantity;
+		OutValue.ValuedResources.AddUnique(Cargo.Resource);
+	}
+	}
 
-			if (!Cargo.Resource)
-			{
-				continue;
-			}
+	{
+	TArray<FFlareCargo>& CargoBaySlots = Spacecraft->GetConstructionCargoBay()->GetSlots();
+	for (int CargoIndex = 0; CargoIndex < CargoBaySlots.Num(); CargoIndex++)
+	{
+		FFlareCargo& Cargo = CargoBaySlots[CargoIndex];
 
-			CompanyValue.StockValue += ReferenceSector->GetResourcePrice(Cargo.Resource, EFlareResourcePriceContext::Default) * Cargo.Quantity;
-		}
+		if (!Cargo.Resource)
+		{
+			continue;
 		}
 
+		Value.StockValue += ReferenceSector->GetResourcePrice(Cargo.Resource, EFlareResourcePriceContext::Default) * Cargo.Quantity;
+		OutValue.ValuedResources.AddUnique(Cargo.Resource);
+	}
+	}
+
+	// Value of factory stock
+	for (int32 FactoryIndex = 0; FactoryIndex < Spacecraft->GetFactories().Num(); FactoryIndex++)
+	{
+		UFlareFactory* Factory = Spacecraft->GetFactories()[FactoryIndex];
+
+		for (int32 ReservedResourceIndex = 0 ; ReservedResourceIndex < Factory->GetReservedResources().Num(); ReservedResourceIndex++)
 		{
-		TArray<FFlareCargo>& CargoBaySlots = Spacecraft->GetConstructionCargoBay()->GetSlots();
-		for (int CargoIndex = 0; CargoIndex < CargoBaySlots.Num(); CargoIndex++)
-		{
-			FFlareCargo& Cargo = CargoBaySlots[CargoIndex];
+			FName ResourceIdentifier = Factory->GetReservedResources()[ReservedResourceIndex].ResourceIdentifier;
+			uint32 Quantity = Factory->GetReservedResources()[ReservedResourceIndex].Quantity;
 
-			if (!Cargo.Resource)
+			FFlareResourceDescription* Resource = Game->GetResourceCatalog()->Get(ResourceIdentifier);
+			if (Resource)
 			{
-				continue;
+				Value.StockValue += ReferenceSector->GetResourcePrice(Resource, EFlareResourcePriceContext::Default) * Quantity;
+				OutValue.ValuedResources.AddUnique(Resource);
 			}
-
-			CompanyValue.StockValue += ReferenceSector->GetResourcePrice(Cargo.Resource, EFlareResourcePriceContext::Default) * Cargo.Quantity;
-		}
-		}
-
-		// Value of factory stock
-		for (int32 FactoryIndex = 0; FactoryIndex < Spacecraft->GetFactories().Num(); FactoryIndex++)
-		{
-			UFlareFactory* Factory = Spacecraft->GetFactories()[FactoryIndex];
-			
-			for (int32 ReservedResourceIndex = 0 ; ReservedResourceIndex < Factory->GetReservedResources().Num(); ReservedResourceIndex++)
+			else
 			{
-				FName ResourceIdentifier = Factory->GetReservedResources()[ReservedResourceIndex].ResourceIdentifier;
-				uint32 Quantity = Factory->GetReservedResources()[ReservedResourceIndex].Quantity;
-
-				FFlareResourceDescription* Resource = Game->GetResourceCatalog()->Get(ResourceIdentifier);
-				if (Resource)
-				{
-					CompanyValue.StockValue += ReferenceSector->GetResourcePrice(Resource, EFlareResourcePriceContext::Default) * Quantity;
-				}
-				else
-				{
-					FLOGV("WARNING: Invalid reserved resource %s (%d reserved) for %s)", *ResourceIdentifier.ToString(), Quantity, *Spacecraft->GetImmatriculation().ToString())
-				}
+				FLOGV("WARNING: Invalid reserved resource %s (%d reserved) for %s)", *ResourceIdentifier.ToString(), Quantity, *Spacecraft->GetImmatriculation().ToString())
 			}
 		}
 	}
 
-	CompanyValue.SpacecraftsValue = CompanyValue.ShipsValue + CompanyValue.StationsValue;
-	CompanyValue.TotalValue = CompanyValue.MoneyValue + CompanyValue.StockValue + CompanyValue.SpacecraftsValue;
-
-	if(globalRequest)
-	{
-		CompanyValueCacheValid = true;
-		CompanyValueCache = CompanyValue;
-	}
-
-	return CompanyValue;
+	return true;
 }
 
 UFlareSimulatedSpacecraft* UFlareCompany::FindSpacecraft(FName ShipImmatriculation, bool Destroyed)
@@ -1673,7 +1910,7 @@ UFlareSimulatedSpacecraft* UFlareCompany::FindSpacecraft(FName ShipImmatriculati
 
 bool UFlareCompany::HasVisitedSector(const UFlareSimulatedSector* Sector) const
 {
-	return Sector && VisitedSectors.Contains(Sector);
+	return Sector && HasIndexBit(VisitedSectorBits, Sector->GetSectorIndex());
 }
 
 FText UFlareCompany::GetPlayerHostilityText() const
@@ -18,6 +18,42 @@ class UFlareCompanyAI;
 class AFlareGame;
 class UFlareSimulatedSpacecraft;
 
+
+/** Contribution of a single spacecraft to its company value */
+struct SpacecraftValue
+{
+	/** Sector whose prices are used to value this spacecraft */
+	UFlareSimulatedSector* ReferenceSector;
+
+	/** True if the spacecraft is not currently in its reference sector */
+	bool Incoming;
+
+	/** Spacecraft, army and stock value. MoneyValue is unused */
+	struct CompanyValue Value;
+
+	/** Resources whose price is part of this value */
+	TArray<FFlareResourceDescription*> ValuedResources;
+};
+
+/** Payments to many companies, applied once per company with merged transaction log entries */
+struct CompanyPaymentBatch
+{
+	struct CompanyPayments
+	{
+		UFlareCompany* Company;
+		int64 Amount;
+		TArray<FFlareTransactionLogEntry> Transactions;
+	};
+
+	/** Queue a payment, merged with the queued payments of the same transaction */
+	void Add(UFlareCompany* Company, int64 Amount, const FFlareTransactionLogEntry& TransactionContext);
+
+	/** Give each company its total and clear the batch */
+	void Apply();
+
+	TArray<CompanyPayments> Payments;
+};
+
 UCLASS()
 class HELIUMRAIN_API UFlareCompany : public UObject
 {
@@ -110,6 +146,12 @@ public:
 	/** Destroy a spacecraft */
 	virtual void DestroySpacecraft(UFlareSimulatedSpacecraft* Spacecraft);
 
+	/** Mark a spacecraft value as outdated, it will be recomputed on next value request */
+	void InvalidateSpacecraftValue(UFlareSimulatedSpacecraft* Spacecraft);
+
+	/** Revalue the spacecraft holding resources whose price changed today */
+	void UpdateCompanyValuePrices();
+
 	/** Set a sector discovered */
 	virtual void DiscoverSector(UFlareSimulatedSector* Sector);
 
@@ -123,6 +165,9 @@ public:
 	/** Give a money amount to the company. In cents */
 	virtual void GiveMoney(int64 Amount, FFlareTransactionLogEntry TransactionContext);
 
+	/** Give the total of several transactions to the company, with one event. Each transaction carries its amount */
+	virtual void GiveMoney(int64 Amount, const TArray<FFlareTransactionLogEntry>& Transactions);
+
 	/** Give a research amount to the company */
 	virtual void GiveResearch(int64 Amount);
 	
@@ -167,6 +212,12 @@ public:
 	/** Check if a technology has been unlocked and is used */
 	bool IsTechnologyUnlocked(FName Identifier) const;
 
+	/** Check if a technology has been unlocked, from its catalog index */
+	bool IsTechnologyIndexUnlocked(int32 TechnologyIndex) const
+	{
+		return HasIndexBit(UnlockedTechnologyBits, TechnologyIndex);
+	}
+
 	/** Check if a technology can be unlocked */
 	bool IsTechnologyAvailable(FName Identifier, FText& Reason, bool IgnoreCost=false) const;
 
@@ -244,20 +295,38 @@ protected:
 	int32                                   ResearchAmount;
 	TMap<FName, FFlareTechnologyDescription*> UnlockedTechnologies;
 
-	mutable struct CompanyValue						CompanyValueCache;
-	mutable bool									CompanyValueCacheValid;
+	// Bitsets indexed by sector and technology indices, mirroring the lists above
+	TBitArray<>                             KnownSectorBits;
+	TBitArray<>                             VisitedSectorBits;
+	TBitArray<>                             UnlockedTechnologyBits;
+
+	static bool HasIndexBit(const TBitArray<>& Bits, int32 Index)
+	{
+		return Index != INDEX_NONE && Index < Bits.Num() && Bits[Index];
+	}
+
+	static void SetIndexBit(TBitArray<>& Bits, int32 Index);
+
+	// Company value running totals, without money
+	mutable struct CompanyValue                             CompanyValueTotals;
+	mutable TMap<UFlareSimulatedSpacecraft*, SpacecraftValue> SpacecraftValues;
+	mutable TSet<UFlareSimulatedSpacecraft*>                DirtySpacecraftValues;
+
+	/** Recompute the value of outdated spacecrafts and update the running totals */
+	void UpdateCompanyValue() const;
+
+	/** Compute the value of a single spacecraft */
+	bool ComputeSpacecraftValue(UFlareSimulatedSpacecraft* Spacecraft, SpacecraftValue& OutValue) const;
+
+	/** Remove a spacecraft from the running totals */
+	void RemoveSpacecraftValue(UFlareSimulatedSpacecraft* Spacecraft);
+
 public:
 
 	/*----------------------------------------------------
 		Getters
 	----------------------------------------------------*/
 
-
-	void InvalidateCompanyValueCache()
-	{
-		CompanyValueCacheValid = false;
-	}
-
 	/** Get the hostility text */
 	FText GetPlayerHostilityText() const;
 
@@ -367,7 +436,11 @@ public:
 
 	inline bool IsKnownSector(UFlareSimulatedSector* Sector) const
 	{
-		return (KnownSectors.Find(Sector) != INDEX_NONE);
+		if (Sector->GetSectorIndex() == INDEX_NONE)
+		{
+			return (KnownSectors.Find(Sector) != INDEX_NONE);
+		}
+		return HasIndexBit(KnownSectorBits, Sector->GetSectorIndex());
 	}
 
 	inline bool IsVisitedSector(UFlareSimulatedSector* Sector) const
@@ -376,7 +449,7 @@ public:
 		{
 			return true;
 		}
-		return (VisitedSectors.Find(Sector) != INDEX_NONE);
+		return HasIndexBit(VisitedSectorBits, Sector->GetSectorIndex());
 	}
 
 	UFlareFleet* FindFleet(FName Identifier) const
@@ -463,6 +536,11 @@ public:
 
 	UFlareSimulatedSpacecraft* FindChildStation(FName StationImmatriculation);
 
+	TArray<FName> const& GetCaptureOrders() const
+	{
+		return CompanyData.CaptureOrders;
+	}
+
 	TArray<FFlareTransactionLogEntry> const& GetTransactionLog() const
 	{
 		return CompanyData.TransactionLog;
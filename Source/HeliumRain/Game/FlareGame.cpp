@@ -41,6 +41,7 @@
 
 #include "AssetRegistryModule.h"
 #include "Log/FlareLogWriter.h"
+#include "Log/FlareEconomyRecorder.h"
 
 #include "Engine/PostProcessVolume.h"
 #include "Engine.h"
@@ -596,6 +597,9 @@ bool AFlareGame::DeleteSaveSlot(int32 Index)
 		FString FileName2 = FString::Printf(TEXT("%s/SaveGames/Game-%s.log"), *FPaths::ProjectSavedDir(), *SaveSlotInfo.UUID.ToString());
 		FLOGV("Delete %s", *FileName2);
 		IFileManager::Get().Delete(*FileName2, true);
+		FString FileName3 = FFlareEconomyRecorder::GetRecordPath(SaveSlotInfo.UUID);
+		FLOGV("Delete %s", *FileName3);
+		IFileManager::Get().Delete(*FileName3, true);
 	}
 
 	bool Deleted = false;
@@ -4,6 +4,7 @@
 
 #include "FlareGame.h"
 #include "FlareCompany.h"
+#include "AI/FlareCompanyAI.h"
 #include "FlarePlanetarium.h"
 #include "FlareSectorHelper.h"
 
@@ -24,6 +25,8 @@
 #define LOCTEXT_NAMESPACE "FlareGameTools"
 
 bool UFlareGameTools::FastFastForward = false;
+float UFlareGameTools::AITimeBudget = 0;
+bool UFlareGameTools::RecordEconomy = false;
 
 /*----------------------------------------------------
 	Constructor
@@ -376,7 +379,7 @@ void UFlareGameTools::PrintEconomyStatus()
 	FLOG("");
 
 	TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats> WorldStats;
-	WorldStats = WorldHelper::ComputeWorldResourceStats(GetGame(), true);
+	WorldStats = GetGameWorld()->GetWorldResourceStats(true);
 
 
 	TArray<UFlareResourceCatalogEntry*> ResourceEntries = GetGame()->GetResourceCatalog()->Resources;
@@ -422,6 +425,74 @@ void UFlareGameTools::PrintEconomyStatus()
 	FLOGV("- People dept: %lld $ (%f %%)", PeopleDept/100, 100.f * (float)PeopleDept / (float) PeopleMoney);
 }
 
+void UFlareGameTools::PrintCompanyAIStats()
+{
+	FLOG("=============");
+	FLOG("Company AI stats");
+	FLOG("=============");
+	FLOGV("Time budget: %.2f ms per company and day", AITimeBudget);
+
+	AIPhaseStats TotalStats[EFlareAIPhase::Count];
+
+	auto PrintPhaseStats = [](EFlareAIPhase::Type Phase, const AIPhaseStats& Stats)
+	{
+		if (Stats.Calls > 0)
+		{
+			FLOGV("- %s: %d calls, %.2f ms total, %.3f ms average, %d degraded",
+				UFlareCompanyAI::GetPhaseName(Phase),
+				Stats.Calls,
+				Stats.Seconds * 1000,
+				Stats.Seconds * 1000 / Stats.Calls,
+				Stats.DegradedCalls);
+		}
+	};
+
+	for (UFlareCompany* Company : GetGameWorld()->GetCompanies())
+	{
+		if (Company == GetPC()->GetCompany())
+		{
+			continue;
+		}
+
+		FLOGV("Company '%s'", *Company->GetCompanyName().ToString());
+
+		for (int32 PhaseIndex = 0; PhaseIndex < EFlareAIPhase::Count; PhaseIndex++)
+		{
+			EFlareAIPhase::Type Phase = (EFlareAIPhase::Type) PhaseIndex;
+			const AIPhaseStats& Stats = Company->GetAI()->GetPhaseStats(Phase);
+			PrintPhaseStats(Phase, Stats);
+
+			TotalStats[PhaseIndex].Seconds += Stats.Seconds;
+			TotalStats[PhaseIndex].Calls += Stats.Calls;
+			TotalStats[PhaseIndex].DegradedCalls += Stats.DegradedCalls;
+		}
+	}
+
+	FLOG("All companies");
+	for (int32 PhaseIndex = 0; PhaseIndex < EFlareAIPhase::Count; PhaseIndex++)
+	{
+		PrintPhaseStats((EFlareAIPhase::Type) PhaseIndex, TotalStats[PhaseIndex]);
+	}
+}
+
+void UFlareGameTools::ResetCompanyAIStats()
+{
+	for (UFlareCompany* Company : GetGameWorld()->GetCompanies())
+	{
+		Company->GetAI()->ResetPhaseStats();
+	}
+}
+
+void UFlareGameTools::SetAITimeBudget(float Milliseconds)
+{
+	AITimeBudget = FMath::Max(0.f, Milliseconds);
+}
+
+void UFlareGameTools::SetEconomyRecorder(bool Enabled)
+{
+	RecordEconomy = Enabled;
+}
+
 void UFlareGameTools::SetAutoSave(bool Autosave)
 {
 	GetGame()->AutoSave = Autosave;
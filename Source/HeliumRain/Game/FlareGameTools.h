@@ -44,6 +44,21 @@ public:
 	UFUNCTION(exec)
 	void PrintEconomyStatus();
 
+	/** Print the time spent by each company AI and by all of them, per phase, with the calls degraded by the time budget */
+	UFUNCTION(exec)
+	void PrintCompanyAIStats();
+
+	UFUNCTION(exec)
+	void ResetCompanyAIStats();
+
+	/** Set the daily AI time budget of each company in milliseconds, 0 to disable */
+	UFUNCTION(exec)
+	void SetAITimeBudget(float Milliseconds);
+
+	/** Record the daily economy state of this game in SaveGames/Economy-<game>.rec */
+	UFUNCTION(exec)
+	void SetEconomyRecorder(bool Enabled);
+
 	UFUNCTION(exec)
 	void SetAutoSave(bool Autosave);
 
@@ -325,4 +340,8 @@ public:
 
 	static bool FastFastForward;
 
+	static float AITimeBudget;
+
+	static bool RecordEconomy;
+
 };
@@ -18,6 +18,7 @@
 
 DECLARE_CYCLE_STAT(TEXT("FlareSectorHelper RepairFleets"), STAT_FlareSectorHelper_RepairFleets, STATGROUP_Flare);
 DECLARE_CYCLE_STAT(TEXT("FlareSectorHelper RefillFleets"), STAT_FlareSectorHelper_RefillFleets, STATGROUP_Flare);
+DECLARE_CYCLE_STAT(TEXT("FlareSectorHelper ComputeFleetSupplyPlan"), STAT_FlareSectorHelper_ComputeFleetSupplyPlan, STATGROUP_Flare);
 
 
 UFlareSimulatedSpacecraft*  SectorHelper::FindTradeStation(FlareTradeRequest Request)
@@ -34,7 +35,6 @@ UFlareSimulatedSpacecraft*  SectorHelper::FindTradeStation(FlareTradeRequest Req
 
 
 	UFlareSimulatedSector* Sector = Request.Client->GetCurrentSector();
-	TArray<UFlareSimulatedSpacecraft*>& SectorStations = Sector->GetSectorStations();
 
 	float UnloadQuantityScoreMultiplier = 0;
 	float LoadQuantityScoreMultiplier = 0;
@@ -86,11 +86,27 @@ UFlareSimulatedSpacecraft*  SectorHelper::FindTradeStation(FlareTradeRequest Req
 	uint32 AvailableQuantity = Request.Client->GetActiveCargoBay()->GetResourceQuantity(Request.Resource, ClientCompany);
 	uint32 FreeSpace = Request.Client->GetActiveCargoBay()->GetFreeSpaceForResource(Request.Resource, ClientCompany);
 
-	for (int32 StationIndex = 0; StationIndex < SectorStations.Num(); StationIndex++)
+	// Only stations using the resource in the right direction can match
+	const SectorTradeCandidates& Candidates = Sector->GetTradeCandidates(Request.Resource);
+	const TArray<UFlareSimulatedSpacecraft*>& Stations = NeedInput ? Candidates.Buyers : Candidates.Sellers;
+	UFlareCompany* HostileCheckedCompany = NULL;
+	bool HostileCompany = false;
+
+	for (UFlareSimulatedSpacecraft* Station : Stations)
 	{
-		UFlareSimulatedSpacecraft* Station = SectorStations[StationIndex];
 		//FLOGV("   Check trade for %s", *Station->GetImmatriculation().ToString());
 
+		// Stations of a hostile company can't trade with the client
+		if (Station->GetCompany() != HostileCheckedCompany)
+		{
+			HostileCheckedCompany = Station->GetCompany();
+			HostileCompany = (Request.Client->GetCompany()->GetWarState(HostileCheckedCompany) == EFlareHostility::Hostile);
+		}
+
+		if (HostileCompany)
+		{
+			continue;
+		}
 
 		FText Unused;
 		if(!Request.Client->CanTradeWith(Station, Unused))
@@ -448,12 +464,8 @@ float SectorHelper::GetComponentMaxRepairRatio(FFlareSpacecraftComponentDescript
 
 bool SectorHelper::HasShipRefilling(UFlareSimulatedSector* TargetSector, UFlareCompany* Company)
 {
-	for (UFlareSimulatedSpacecraft* Spacecraft : TargetSector->GetSectorSpacecrafts())
+	for (UFlareSimulatedSpacecraft* Spacecraft : TargetSector->GetCompanySpacecrafts(Company).Spacecrafts)
 	{
-		if (Company != Spacecraft->GetCompany()) {
-			continue;
-		}
-
 		if (Spacecraft->GetRefillStock() > 0 && Spacecraft->NeedRefill())
 		{
 			return true;
@@ -465,12 +477,8 @@ bool SectorHelper::HasShipRefilling(UFlareSimulatedSector* TargetSector, UFlareC
 
 bool SectorHelper::HasShipRepairing(UFlareSimulatedSector* TargetSector, UFlareCompany* Company)
 {
-	for (UFlareSimulatedSpacecraft* Spacecraft : TargetSector->GetSectorSpacecrafts())
+	for (UFlareSimulatedSpacecraft* Spacecraft : TargetSector->GetCompanySpacecrafts(Company).Spacecrafts)
 	{
-		if (Company != Spacecraft->GetCompany()) {
-			continue;
-		}
-
 		if (Spacecraft->GetRepairStock() > 0 && Spacecraft->GetDamageSystem()->GetGlobalDamageRatio() < 1.f)
 		{
 			return true;
@@ -479,40 +487,26 @@ bool SectorHelper::HasShipRepairing(UFlareSimulatedSector* TargetSector, UFlareC
 	return false;
 }
 
-void SectorHelper::GetRepairFleetSupplyNeeds(UFlareSimulatedSector* Sector, UFlareCompany* Company, int32& CurrentNeededFleetSupply, int32& TotalNeededFleetSupply, int64& MaxDuration, bool OnlyPossible)
+void SectorHelper::ComputeFleetSupplyPlan(UFlareSimulatedSector* Sector, UFlareCompany* Company, bool OnlyPossible, FlareFleetSupplyPlan& OutPlan)
 {
-	TArray<UFlareSimulatedSpacecraft*> CompanySpacecraft;
-
 	if(OnlyPossible && Sector->IsInDangerousBattle(Company))
 	{
 		// Don't add any spacecraft
-	}
-	else
-	{
-		for (int32 SpacecraftIndex = 0; SpacecraftIndex < Sector->GetSectorSpacecrafts().Num(); SpacecraftIndex++)
-		{
-			UFlareSimulatedSpacecraft* Spacecraft = Sector->GetSectorSpacecrafts()[SpacecraftIndex];
-
-			if (Company != Spacecraft->GetCompany()) {
-				continue;
-			}
-
-			CompanySpacecraft.Add(Spacecraft);
-		}
+		OutPlan.Spacecrafts.Reset();
+		return;
 	}
 
-	GetRepairFleetSupplyNeeds(Sector, CompanySpacecraft, CurrentNeededFleetSupply, TotalNeededFleetSupply, MaxDuration, OnlyPossible);
+	ComputeFleetSupplyPlan(Sector, Sector->GetCompanySpacecrafts(Company).Spacecrafts, OnlyPossible, OutPlan);
 }
 
-void SectorHelper::GetRepairFleetSupplyNeeds(UFlareSimulatedSector* Sector,  TArray<UFlareSimulatedSpacecraft*>& ships, int32& CurrentNeededFleetSupply, int32& TotalNeededFleetSupply, int64& MaxDuration, bool OnlyPossible)
+void SectorHelper::ComputeFleetSupplyPlan(UFlareSimulatedSector* Sector, const TArray<UFlareSimulatedSpacecraft*>& Ships, bool OnlyPossible, FlareFleetSupplyPlan& OutPlan)
 {
-	float PreciseCurrentNeededFleetSupply = 0;
-	float PreciseTotalNeededFleetSupply = 0;
-	MaxDuration = 0;
+	SCOPE_CYCLE_COUNTER(STAT_FlareSectorHelper_ComputeFleetSupplyPlan);
 
+	OutPlan.Spacecrafts.Reset();
 	UFlareSpacecraftComponentsCatalog* Catalog = Sector->GetGame()->GetShipPartsCatalog();
 
-	for(UFlareSimulatedSpacecraft* Spacecraft: ships)
+	for(UFlareSimulatedSpacecraft* Spacecraft: Ships)
 	{
 		if (!Spacecraft->GetDamageSystem()->IsAlive()) {
 			continue;
@@ -523,36 +517,83 @@ void SectorHelper::GetRepairFleetSupplyNeeds(UFlareSimulatedSector* Sector,  TAr
 			continue;
 		}
 
-		float SpacecraftPreciseCurrentNeededFleetSupply = 0;
-		float SpacecraftPreciseTotalNeededFleetSupply = 0;
+		FlareSpacecraftSupplyNeeds& Needs = OutPlan.Spacecrafts[OutPlan.Spacecrafts.AddDefaulted()];
+		Needs.Spacecraft = Spacecraft;
 
-		// List components
+		float SizeRatio = (Spacecraft->GetSize() == EFlarePartSize::L ? 0.2f : 1.f);
+		float TechnologyBonus = Spacecraft->GetCompany()->IsTechnologyUnlocked("quick-repair") ? 1.5f: 1.f;
+		float MaxRefillRatio = MAX_REFILL_RATIO_BY_DAY * SizeRatio;
+
+		// List components once for both repair and refill
 		for (int32 ComponentIndex = 0; ComponentIndex < Spacecraft->GetData().Components.Num(); ComponentIndex++)
 		{
 			FFlareSpacecraftComponentSave* ComponentData = &Spacecraft->GetData().Components[ComponentIndex];
 			FFlareSpacecraftComponentDescription* ComponentDescription = Catalog->Get(ComponentData->ComponentIdentifier);
 
 			float DamageRatio = Spacecraft->GetDamageSystem()->GetDamageRatio(ComponentDescription, ComponentData);
-
-			float TechnologyBonus = Spacecraft->GetCompany()->IsTechnologyUnlocked("quick-repair") ? 1.5f: 1.f;
-
-			float ComponentMaxRepairRatio = GetComponentMaxRepairRatio(ComponentDescription) * (Spacecraft->GetSize() == EFlarePartSize::L ? 0.2f : 1.f) * TechnologyBonus;
+			float ComponentMaxRepairRatio = GetComponentMaxRepairRatio(ComponentDescription) * SizeRatio * TechnologyBonus;
 
 			float CurrentRepairRatio = FMath::Min(ComponentMaxRepairRatio, (1.f - DamageRatio));
 			float TotalRepairRatio = 1.f - DamageRatio;
 
-			int64 Duration =  FMath::CeilToInt(TotalRepairRatio / ComponentMaxRepairRatio);
-			if(Duration > MaxDuration)
+			int64 RepairDuration = FMath::CeilToInt(TotalRepairRatio / ComponentMaxRepairRatio);
+			if(RepairDuration > Needs.RepairDuration)
 			{
-				MaxDuration = Duration;
+				Needs.RepairDuration = RepairDuration;
 			}
 
-			SpacecraftPreciseCurrentNeededFleetSupply += CurrentRepairRatio * UFlareSimulatedSpacecraftDamageSystem::GetRepairCost(ComponentDescription);
-			SpacecraftPreciseTotalNeededFleetSupply += TotalRepairRatio * UFlareSimulatedSpacecraftDamageSystem::GetRepairCost(ComponentDescription);
+			Needs.CurrentRepair += CurrentRepairRatio * UFlareSimulatedSpacecraftDamageSystem::GetRepairCost(ComponentDescription);
+			Needs.TotalRepair += TotalRepairRatio * UFlareSimulatedSpacecraftDamageSystem::GetRepairCost(ComponentDescription);
+
+			if(ComponentDescription->Type == EFlarePartType::Weapon)
+			{
+				int32 MaxAmmo = ComponentDescription->WeaponCharacteristics.AmmoCapacity;
+				int32 CurrentAmmo = MaxAmmo - ComponentData->Weapon.FiredAmmo;
+
+				float FillRatio = (float) CurrentAmmo / (float) MaxAmmo;
+
+				float CurrentRefillRatio = FMath::Min(MaxRefillRatio, (1.f - FillRatio));
+				float TotalRefillRatio = 1.f - FillRatio;
+
+				int64 RefillDuration = FMath::CeilToInt(TotalRefillRatio / MaxRefillRatio);
+				if(RefillDuration > Needs.RefillDuration)
+				{
+					Needs.RefillDuration = RefillDuration;
+				}
+
+				Needs.CurrentRefill += CurrentRefillRatio * UFlareSimulatedSpacecraftDamageSystem::GetRefillCost(ComponentDescription);
+				Needs.TotalRefill += TotalRefillRatio * UFlareSimulatedSpacecraftDamageSystem::GetRefillCost(ComponentDescription);
+			}
 		}
+	}
+}
+
+void SectorHelper::GetRepairFleetSupplyNeeds(UFlareSimulatedSector* Sector, UFlareCompany* Company, int32& CurrentNeededFleetSupply, int32& TotalNeededFleetSupply, int64& MaxDuration, bool OnlyPossible)
+{
+	FlareFleetSupplyPlan Plan;
+	ComputeFleetSupplyPlan(Sector, Company, OnlyPossible, Plan);
+	GetRepairFleetSupplyNeeds(Plan, CurrentNeededFleetSupply, TotalNeededFleetSupply, MaxDuration);
+}
 
-		PreciseCurrentNeededFleetSupply += FMath::Max(0.f, SpacecraftPreciseCurrentNeededFleetSupply - Spacecraft->GetRepairStock());
-		PreciseTotalNeededFleetSupply += FMath::Max(0.f, SpacecraftPreciseTotalNeededFleetSupply - Spacecraft->GetRepairStock());
+void SectorHelper::GetRepairFleetSupplyNeeds(UFlareSimulatedSector* Sector,  TArray<UFlareSimulatedSpacecraft*>& ships, int32& CurrentNeededFleetSupply, int32& TotalNeededFleetSupply, int64& MaxDuration, bool OnlyPossible)
+{
+	FlareFleetSupplyPlan Plan;
+	ComputeFleetSupplyPlan(Sector, ships, OnlyPossible, Plan);
+	GetRepairFleetSupplyNeeds(Plan, CurrentNeededFleetSupply, TotalNeededFleetSupply, MaxDuration);
+}
+
+void SectorHelper::GetRepairFleetSupplyNeeds(const FlareFleetSupplyPlan& Plan, int32& CurrentNeededFleetSupply, int32& TotalNeededFleetSupply, int64& MaxDuration)
+{
+	float PreciseCurrentNeededFleetSupply = 0;
+	float PreciseTotalNeededFleetSupply = 0;
+	MaxDuration = 0;
+
+	for (const FlareSpacecraftSupplyNeeds& Needs : Plan.Spacecrafts)
+	{
+		MaxDuration = FMath::Max(MaxDuration, Needs.RepairDuration);
+
+		PreciseCurrentNeededFleetSupply += FMath::Max(0.f, Needs.CurrentRepair - Needs.Spacecraft->GetRepairStock());
+		PreciseTotalNeededFleetSupply += FMath::Max(0.f, Needs.TotalRepair - Needs.Spacecraft->GetRepairStock());
 	}
 
 	// Round to ceil
@@ -573,81 +614,30 @@ void SectorHelper::GetRepairFleetSupplyNeeds(UFlareSimulatedSector* Sector,  TAr
 
 void SectorHelper::GetRefillFleetSupplyNeeds(UFlareSimulatedSector* Sector, UFlareCompany* Company, int32& CurrentNeededFleetSupply, int32& TotalNeededFleetSupply, int64& MaxDuration, bool OnlyPossible)
 {
-	TArray<UFlareSimulatedSpacecraft*> CompanySpacecraft;
-
-	if(OnlyPossible && Sector->IsInDangerousBattle(Company))
-	{
-		// Don't add any spacecraft
-	}
-	else
-	{
-		for (int32 SpacecraftIndex = 0; SpacecraftIndex < Sector->GetSectorSpacecrafts().Num(); SpacecraftIndex++)
-		{
-			UFlareSimulatedSpacecraft* Spacecraft = Sector->GetSectorSpacecrafts()[SpacecraftIndex];
-
-			if (Company != Spacecraft->GetCompany()) {
-				continue;
-			}
-
-			CompanySpacecraft.Add(Spacecraft);
-		}
-	}
-
-	GetRefillFleetSupplyNeeds(Sector, CompanySpacecraft, CurrentNeededFleetSupply, TotalNeededFleetSupply, MaxDuration, OnlyPossible);
+	FlareFleetSupplyPlan Plan;
+	ComputeFleetSupplyPlan(Sector, Company, OnlyPossible, Plan);
+	GetRefillFleetSupplyNeeds(Plan, CurrentNeededFleetSupply, TotalNeededFleetSupply, MaxDuration);
 }
 
 void SectorHelper::GetRefillFleetSupplyNeeds(UFlareSimulatedSector* Sector, TArray<UFlareSimulatedSpacecraft*>& ships, int32& CurrentNeededFleetSupply, int32& TotalNeededFleetSupply, int64& MaxDuration, bool OnlyPossible)
+{
+	FlareFleetSupplyPlan Plan;
+	ComputeFleetSupplyPlan(Sector, ships, OnlyPossible, Plan);
+	GetRefillFleetSupplyNeeds(Plan, CurrentNeededFleetSupply, TotalNeededFleetSupply, MaxDuration);
+}
+
+void SectorHelper::GetRefillFleetSupplyNeeds(const FlareFleetSupplyPlan& Plan, int32& CurrentNeededFleetSupply, int32& TotalNeededFleetSupply, int64& MaxDuration)
 {
 	float PreciseCurrentNeededFleetSupply = 0;
 	float PreciseTotalNeededFleetSupply = 0;
 	MaxDuration = 0;
-	UFlareSpacecraftComponentsCatalog* Catalog = Sector->GetGame()->GetShipPartsCatalog();
 
-	for(UFlareSimulatedSpacecraft* Spacecraft: ships)
+	for (const FlareSpacecraftSupplyNeeds& Needs : Plan.Spacecrafts)
 	{
-		if (!Spacecraft->GetDamageSystem()->IsAlive()) {
-			continue;
-		}
-
-		if(OnlyPossible && Sector->IsInDangerousBattle(Spacecraft->GetCompany()))
-		{
-			continue;
-		}
-
-		float SpacecraftPreciseCurrentNeededFleetSupply = 0;
-		float SpacecraftPreciseTotalNeededFleetSupply = 0;
-
-		// List components
-		for (int32 ComponentIndex = 0; ComponentIndex < Spacecraft->GetData().Components.Num(); ComponentIndex++)
-		{
-			FFlareSpacecraftComponentSave* ComponentData = &Spacecraft->GetData().Components[ComponentIndex];
-			FFlareSpacecraftComponentDescription* ComponentDescription = Catalog->Get(ComponentData->ComponentIdentifier);
-
-			if(ComponentDescription->Type == EFlarePartType::Weapon)
-			{
-
-				int32 MaxAmmo = ComponentDescription->WeaponCharacteristics.AmmoCapacity;
-				int32 CurrentAmmo = MaxAmmo - ComponentData->Weapon.FiredAmmo;
-
-				float FillRatio = (float) CurrentAmmo / (float) MaxAmmo;
+		MaxDuration = FMath::Max(MaxDuration, Needs.RefillDuration);
 
-
-				float CurrentRefillRatio = FMath::Min(MAX_REFILL_RATIO_BY_DAY * (Spacecraft->GetSize() == EFlarePartSize::L ? 0.2f : 1.f) , (1.f - FillRatio));
-				float TotalRefillRatio = 1.f - FillRatio;
-
-				int64 Duration =  FMath::CeilToInt(TotalRefillRatio / (MAX_REFILL_RATIO_BY_DAY * (Spacecraft->GetSize() == EFlarePartSize::L ? 0.2f : 1.f)));
-				if(Duration > MaxDuration)
-				{
-					MaxDuration = Duration;
-				}
-
-				SpacecraftPreciseCurrentNeededFleetSupply += CurrentRefillRatio * UFlareSimulatedSpacecraftDamageSystem::GetRefillCost(ComponentDescription);
-				SpacecraftPreciseTotalNeededFleetSupply += TotalRefillRatio * UFlareSimulatedSpacecraftDamageSystem::GetRefillCost(ComponentDescription);
-			}
-		}
-
-		PreciseCurrentNeededFleetSupply += FMath::Max(0.f, SpacecraftPreciseCurrentNeededFleetSupply - Spacecraft->GetRefillStock());
-		PreciseTotalNeededFleetSupply += FMath::Max(0.f, SpacecraftPreciseTotalNeededFleetSupply - Spacecraft->GetRefillStock());
+		PreciseCurrentNeededFleetSupply += FMath::Max(0.f, Needs.CurrentRefill - Needs.Spacecraft->GetRefillStock());
+		PreciseTotalNeededFleetSupply += FMath::Max(0.f, Needs.TotalRefill - Needs.Spacecraft->GetRefillStock());
 	}
 
 	// Round to ceil
@@ -657,6 +647,13 @@ void SectorHelper::GetRefillFleetSupplyNeeds(UFlareSimulatedSector* Sector, TArr
 
 
 void SectorHelper::RepairFleets(UFlareSimulatedSector* Sector, UFlareCompany* Company)
+{
+	FlareFleetSupplyPlan Plan;
+	ComputeFleetSupplyPlan(Sector, Company, true, Plan);
+	RepairFleets(Sector, Company, Plan);
+}
+
+void SectorHelper::RepairFleets(UFlareSimulatedSector* Sector, UFlareCompany* Company, const FlareFleetSupplyPlan& Plan)
 {
 	SCOPE_CYCLE_COUNTER(STAT_FlareSectorHelper_RepairFleets);
 	int32 CurrentNeededFleetSupply;
@@ -667,7 +664,7 @@ void SectorHelper::RepairFleets(UFlareSimulatedSector* Sector, UFlareCompany* Co
 	int64 MaxDuration;
 
 
-	GetRepairFleetSupplyNeeds(Sector, Company, CurrentNeededFleetSupply, TotalNeededFleetSupply, MaxDuration, true);
+	GetRepairFleetSupplyNeeds(Plan, CurrentNeededFleetSupply, TotalNeededFleetSupply, MaxDuration);
 	GetAvailableFleetSupplyCount(Sector, Company, OwnedFS, AvailableFS, AffordableFS);
 
 
@@ -685,38 +682,13 @@ void SectorHelper::RepairFleets(UFlareSimulatedSector* Sector, UFlareCompany* Co
 
 	float RepairRatio = FMath::Min(1.f,(float) AffordableFS /  (float) TotalNeededFleetSupply);
 	float RemainingFS = (float) AffordableFS;
-	UFlareSpacecraftComponentsCatalog* Catalog = Company->GetGame()->GetShipPartsCatalog();
-
 
-	for (int32 SpacecraftIndex = 0; SpacecraftIndex < Sector->GetSectorSpacecrafts().Num(); SpacecraftIndex++)
+	for (const FlareSpacecraftSupplyNeeds& Needs : Plan.Spacecrafts)
 	{
-		UFlareSimulatedSpacecraft* Spacecraft = Sector->GetSectorSpacecrafts()[SpacecraftIndex];
-
-		if (Company != Spacecraft->GetCompany() || !Spacecraft->GetDamageSystem()->IsAlive()) {
-			continue;
-		}
-
-		float SpacecraftPreciseTotalNeededFleetSupply = 0;
-
-
-		// List components
-		for (int32 ComponentIndex = 0; ComponentIndex < Spacecraft->GetData().Components.Num(); ComponentIndex++)
-		{
-			FFlareSpacecraftComponentSave* ComponentData = &Spacecraft->GetData().Components[ComponentIndex];
-			FFlareSpacecraftComponentDescription* ComponentDescription = Catalog->Get(ComponentData->ComponentIdentifier);
-
-			float DamageRatio = Spacecraft->GetDamageSystem()->GetDamageRatio(ComponentDescription, ComponentData);
-			float TotalRepairRatio = 1.f - DamageRatio;
-
-			SpacecraftPreciseTotalNeededFleetSupply += TotalRepairRatio * UFlareSimulatedSpacecraftDamageSystem::GetRepairCost(ComponentDescription);
-
-
-		}
-
-		float SpacecraftNeededWithoutStock = SpacecraftPreciseTotalNeededFleetSupply - Spacecraft->GetRepairStock();
+		float SpacecraftNeededWithoutStock = Needs.TotalRepair - Needs.Spacecraft->GetRepairStock();
 		float SpacecraftNeededWithoutStockScaled = FMath::Max(0.f, SpacecraftNeededWithoutStock * RepairRatio);
 		float ConsumedFS = FMath::Min(RemainingFS, SpacecraftNeededWithoutStockScaled);
-		Spacecraft->OrderRepairStock(ConsumedFS);
+		Needs.Spacecraft->OrderRepairStock(ConsumedFS);
 		RemainingFS -= ConsumedFS;
 
 		if(RemainingFS <= 0)
@@ -735,6 +707,13 @@ void SectorHelper::RepairFleets(UFlareSimulatedSector* Sector, UFlareCompany* Co
 }
 
 void SectorHelper::RefillFleets(UFlareSimulatedSector* Sector, UFlareCompany* Company)
+{
+	FlareFleetSupplyPlan Plan;
+	ComputeFleetSupplyPlan(Sector, Company, true, Plan);
+	RefillFleets(Sector, Company, Plan);
+}
+
+void SectorHelper::RefillFleets(UFlareSimulatedSector* Sector, UFlareCompany* Company, const FlareFleetSupplyPlan& Plan)
 {
 	SCOPE_CYCLE_COUNTER(STAT_FlareSectorHelper_RefillFleets);
 
@@ -745,7 +724,7 @@ void SectorHelper::RefillFleets(UFlareSimulatedSector* Sector, UFlareCompany* Co
 	int32 AffordableFS;
 	int64 MaxDuration;
 
-	GetRefillFleetSupplyNeeds(Sector, Company, CurrentNeededFleetSupply, TotalNeededFleetSupply, MaxDuration, true);
+	GetRefillFleetSupplyNeeds(Plan, CurrentNeededFleetSupply, TotalNeededFleetSupply, MaxDuration);
 	GetAvailableFleetSupplyCount(Sector, Company, OwnedFS, AvailableFS, AffordableFS);
 
 
@@ -760,43 +739,15 @@ void SectorHelper::RefillFleets(UFlareSimulatedSector* Sector, UFlareCompany* Co
 
 	float MaxRefillRatio = FMath::Min(1.f,(float) AffordableFS /  (float) TotalNeededFleetSupply);
 	float RemainingFS = (float) AffordableFS;
-	UFlareSpacecraftComponentsCatalog* Catalog = Company->GetGame()->GetShipPartsCatalog();
 
-	for (int32 SpacecraftIndex = 0; SpacecraftIndex < Sector->GetSectorSpacecrafts().Num(); SpacecraftIndex++)
+	for (const FlareSpacecraftSupplyNeeds& Needs : Plan.Spacecrafts)
 	{
-		UFlareSimulatedSpacecraft* Spacecraft = Sector->GetSectorSpacecrafts()[SpacecraftIndex];
-
-		if (Company != Spacecraft->GetCompany() || !Spacecraft->GetDamageSystem()->IsAlive()) {
-			continue;
-		}
-
-		float SpacecraftPreciseTotalNeededFleetSupply = 0;
-
-		// List components
-		for (int32 ComponentIndex = 0; ComponentIndex < Spacecraft->GetData().Components.Num(); ComponentIndex++)
-		{
-			FFlareSpacecraftComponentSave* ComponentData = &Spacecraft->GetData().Components[ComponentIndex];
-			FFlareSpacecraftComponentDescription* ComponentDescription = Catalog->Get(ComponentData->ComponentIdentifier);
-
-			if(ComponentDescription->Type == EFlarePartType::Weapon)
-			{
-				int32 MaxAmmo = ComponentDescription->WeaponCharacteristics.AmmoCapacity;
-				int32 CurrentAmmo = MaxAmmo - ComponentData->Weapon.FiredAmmo;
-
-				float FillRatio = (float) CurrentAmmo / (float) MaxAmmo;
-
-				float TotalRefillRatio = 1.f - FillRatio;
-
-				SpacecraftPreciseTotalNeededFleetSupply += TotalRefillRatio * UFlareSimulatedSpacecraftDamageSystem::GetRefillCost(ComponentDescription);
-			}
-		}
-
-		float SpacecraftNeededWithoutStock = SpacecraftPreciseTotalNeededFleetSupply - Spacecraft->GetRefillStock();
+		float SpacecraftNeededWithoutStock = Needs.TotalRefill - Needs.Spacecraft->GetRefillStock();
 		float SpacecraftNeededWithoutStockScaled = FMath::Max(0.f, SpacecraftNeededWithoutStock * MaxRefillRatio);
 
 		float ConsumedFS = FMath::Min(RemainingFS, SpacecraftNeededWithoutStockScaled);
 
-		Spacecraft->OrderRefillStock(ConsumedFS);
+		Needs.Spacecraft->OrderRefillStock(ConsumedFS);
 		RemainingFS -= ConsumedFS;
 
 		if(RemainingFS <= 0)
@@ -822,15 +773,8 @@ void SectorHelper::ConsumeFleetSupply(UFlareSimulatedSector* Sector, UFlareCompa
 
 	FFlareResourceDescription* FleetSupply = Sector->GetGame()->GetScenarioTools()->FleetSupply;
 
-	for (int32 SpacecraftIndex = 0; SpacecraftIndex < Sector->GetSectorSpacecrafts().Num(); SpacecraftIndex++)
+	for (UFlareSimulatedSpacecraft* Spacecraft : Sector->GetCompanySpacecrafts(Company).Spacecrafts)
 	{
-		UFlareSimulatedSpacecraft* Spacecraft = Sector->GetSectorSpacecrafts()[SpacecraftIndex];
-
-		if (Company != Spacecraft->GetCompany())
-		{
-			continue;
-		}
-
 		int TakenQuantity = Spacecraft->GetActiveCargoBay()->TakeResources(FleetSupply, ConsumedFS, Company);
 		ConsumedFS -= TakenQuantity;
 
@@ -908,13 +852,17 @@ int32 SectorHelper::GetHostileArmyCombatPoints(UFlareSimulatedSector* Sector, UF
 {
 	int32 HostileCombatPoints = 0;
 
-	for(UFlareSimulatedSpacecraft* Spacecraft: Sector->GetSectorSpacecrafts())
+	for (auto& CompanyEntry : Sector->GetSpacecraftsByCompany())
 	{
-		if(Spacecraft->GetCompany()->GetWarState(Company) != EFlareHostility::Hostile)
+		if(CompanyEntry.Key->GetWarState(Company) != EFlareHostility::Hostile)
 		{
 			continue;
 		}
-		HostileCombatPoints += Spacecraft->GetCombatPoints(ReduceByDamage);
+
+		for(UFlareSimulatedSpacecraft* Spacecraft: CompanyEntry.Value.Spacecrafts)
+		{
+			HostileCombatPoints += Spacecraft->GetCombatPoints(ReduceByDamage);
+		}
 	}
 	return HostileCombatPoints;
 }
@@ -923,149 +871,179 @@ int32 SectorHelper::GetCompanyArmyCombatPoints(UFlareSimulatedSector* Sector, UF
 {
 	int32 CompanyCombatPoints = 0;
 
-	for(UFlareSimulatedSpacecraft* Spacecraft: Sector->GetSectorSpacecrafts())
+	for(UFlareSimulatedSpacecraft* Spacecraft: Sector->GetCompanySpacecrafts(Company).Spacecrafts)
 	{
-		if(Spacecraft->GetCompany() != Company)
-		{
-			continue;
-		}
 		CompanyCombatPoints += Spacecraft->GetCombatPoints(ReduceByDamage);
 	}
 	return CompanyCombatPoints;
 }
 
 
-TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats> SectorHelper::ComputeSectorResourceStats(UFlareSimulatedSector* Sector, bool IncludeStorage)
+static WorldHelper::FlareResourceStats& FindOrAddResourceStats(TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats>& Stats, FFlareResourceDescription* Resource)
 {
-	TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats> WorldStats;
-
-	// Init
-	for(int32 ResourceIndex = 0; ResourceIndex < Sector->GetGame()->GetResourceCatalog()->Resources.Num(); ResourceIndex++)
+	WorldHelper::FlareResourceStats* ResourceStats = Stats.Find(Resource);
+	if (!ResourceStats)
 	{
-		FFlareResourceDescription* Resource = &Sector->GetGame()->GetResourceCatalog()->Resources[ResourceIndex]->Data;
-		WorldHelper::FlareResourceStats ResourceStats;
-		ResourceStats.Production = 0;
-		ResourceStats.Consumption = 0;
-		ResourceStats.Balance = 0;
-		ResourceStats.Stock = 0;
-		ResourceStats.Capacity = 0;
-
-		WorldStats.Add(Resource, ResourceStats);
+		WorldHelper::FlareResourceStats NewResourceStats;
+		NewResourceStats.Production = 0;
+		NewResourceStats.Consumption = 0;
+		NewResourceStats.Balance = 0;
+		NewResourceStats.Stock = 0;
+		NewResourceStats.Capacity = 0;
+
+		ResourceStats = &Stats.Add(Resource, NewResourceStats);
 	}
 
-	for (int SpacecraftIndex = 0; SpacecraftIndex < Sector->GetSectorSpacecrafts().Num(); SpacecraftIndex++)
+	return *ResourceStats;
+}
+
+void SectorHelper::AddSpacecraftStockStats(UFlareSimulatedSpacecraft* Spacecraft, TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats>& Stats)
+{
+	TArray<FFlareCargo>& CargoBaySlots = Spacecraft->GetActiveCargoBay()->GetSlots();
+	for (int CargoIndex = 0; CargoIndex < CargoBaySlots.Num(); CargoIndex++)
 	{
-		UFlareSimulatedSpacecraft* Spacecraft = Sector->GetSectorSpacecrafts()[SpacecraftIndex];
+		FFlareCargo& Cargo = CargoBaySlots[CargoIndex];
 
-		if(!IncludeStorage && Spacecraft->HasCapability(EFlareSpacecraftCapability::Storage))
+		if (!Cargo.Resource)
 		{
 			continue;
 		}
 
-		// Stock
-		TArray<FFlareCargo>& CargoBaySlots = Spacecraft->GetActiveCargoBay()->GetSlots();
-		for (int CargoIndex = 0; CargoIndex < CargoBaySlots.Num(); CargoIndex++)
-		{
-			FFlareCargo& Cargo = CargoBaySlots[CargoIndex];
+		WorldHelper::FlareResourceStats *ResourceStats = &FindOrAddResourceStats(Stats, Cargo.Resource);
 
-			if (!Cargo.Resource)
-			{
-				continue;
-			}
-
-			WorldHelper::FlareResourceStats *ResourceStats = &WorldStats[Cargo.Resource];
+		FFlareResourceUsage Usage = Spacecraft->GetResourceUseType(Cargo.Resource);
 
-			FFlareResourceUsage Usage = Spacecraft->GetResourceUseType(Cargo.Resource);
-
-			if(Usage.HasUsage(EFlareResourcePriceContext::FactoryInput) || Usage.HasUsage(EFlareResourcePriceContext::ConsumerConsumption) || Usage.HasUsage(EFlareResourcePriceContext::MaintenanceConsumption) || Usage.HasUsage(EFlareResourcePriceContext::HubInput))
-			{
-				ResourceStats->Capacity += Spacecraft->GetActiveCargoBay()->GetSlotCapacity() - Cargo.Quantity;
-			}
+		if(Usage.HasUsage(EFlareResourcePriceContext::FactoryInput) || Usage.HasUsage(EFlareResourcePriceContext::ConsumerConsumption) || Usage.HasUsage(EFlareResourcePriceContext::MaintenanceConsumption) || Usage.HasUsage(EFlareResourcePriceContext::HubInput))
+		{
+			ResourceStats->Capacity += Spacecraft->GetActiveCargoBay()->GetSlotCapacity() - Cargo.Quantity;
+		}
 
-			if(Usage.HasUsage(EFlareResourcePriceContext::FactoryOutput) || Usage.HasUsage(EFlareResourcePriceContext::MaintenanceConsumption) || Usage.HasUsage(EFlareResourcePriceContext::HubOutput))
-			{
-				ResourceStats->Stock += Cargo.Quantity;
-			}
+		if(Usage.HasUsage(EFlareResourcePriceContext::FactoryOutput) || Usage.HasUsage(EFlareResourcePriceContext::MaintenanceConsumption) || Usage.HasUsage(EFlareResourcePriceContext::HubOutput))
+		{
+			ResourceStats->Stock += Cargo.Quantity;
 		}
+	}
+}
 
-		for (int32 FactoryIndex = 0; FactoryIndex < Spacecraft->GetFactories().Num(); FactoryIndex++)
+void SectorHelper::AddSpacecraftFlowStats(UFlareSimulatedSpacecraft* Spacecraft, TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats>& Stats)
+{
+	for (int32 FactoryIndex = 0; FactoryIndex < Spacecraft->GetFactories().Num(); FactoryIndex++)
+	{
+		UFlareFactory* Factory = Spacecraft->GetFactories()[FactoryIndex];
+
+		if(Factory->IsShipyard() && !Factory->IsActive())
 		{
-			UFlareFactory* Factory = Spacecraft->GetFactories()[FactoryIndex];
+			const FFlareProductionData* ProductionData = Spacecraft->GetNextOrderShipProductionData(Factory->IsLargeShipyard()? EFlarePartSize::L : EFlarePartSize::S);
 
-			if(Factory->IsShipyard() && !Factory->IsActive())
+			if (ProductionData)
 			{
-				const FFlareProductionData* ProductionData = Spacecraft->GetNextOrderShipProductionData(Factory->IsLargeShipyard()? EFlarePartSize::L : EFlarePartSize::S);
-
-				if (ProductionData)
+				for(const FFlareFactoryResource& FactoryResource : ProductionData->InputResources)
 				{
-					for(const FFlareFactoryResource& FactoryResource : ProductionData->InputResources)
-					{
-						const FFlareResourceDescription* Resource = &FactoryResource.Resource->Data;
-						WorldHelper::FlareResourceStats *ResourceStats = &WorldStats[Resource];
+					FFlareResourceDescription* Resource = &FactoryResource.Resource->Data;
+					WorldHelper::FlareResourceStats *ResourceStats = &FindOrAddResourceStats(Stats, Resource);
 
-						int64 ProductionDuration = ProductionData->ProductionTime;
+					int64 ProductionDuration = ProductionData->ProductionTime;
 
-						float Flow = 0;
+					float Flow = 0;
 
-						if (ProductionDuration == 0)
-						{
-							Flow = 1;
-						}
-						else
-						{
-							Flow = (float) FactoryResource.Quantity / float(ProductionDuration);
-						}
-
-						ResourceStats->Consumption += Flow;
+					if (ProductionDuration == 0)
+					{
+						Flow = 1;
+					}
+					else
+					{
+						Flow = (float) FactoryResource.Quantity / float(ProductionDuration);
 					}
-				}
 
-				continue;
+					ResourceStats->Consumption += Flow;
+				}
 			}
 
-			if ((!Factory->IsActive() || !Factory->IsNeedProduction()))
+			continue;
+		}
+
+		if ((!Factory->IsActive() || !Factory->IsNeedProduction()))
+		{
+			// No resources needed
+			continue;
+		}
+
+		// Input flow
+		for (int32 ResourceIndex = 0; ResourceIndex < Factory->GetInputResourcesCount(); ResourceIndex++)
+		{
+			FFlareResourceDescription* Resource = Factory->GetInputResource(ResourceIndex);
+			WorldHelper::FlareResourceStats *ResourceStats = &FindOrAddResourceStats(Stats, Resource);
+
+			int64 ProductionDuration = Factory->GetProductionDuration();
+
+			float Flow = 0;
+
+			if (ProductionDuration == 0)
 			{
-				// No resources needed
-				continue;
+				Flow = 1;
+			}
+			else
+			{
+				Flow = (float) Factory->GetInputResourceQuantity(ResourceIndex) / float(ProductionDuration);
 			}
 
-			// Input flow
-			for (int32 ResourceIndex = 0; ResourceIndex < Factory->GetInputResourcesCount(); ResourceIndex++)
+			ResourceStats->Consumption += Flow;
+		}
+
+		// Ouput flow
+		for (int32 ResourceIndex = 0; ResourceIndex < Factory->GetOutputResourcesCount(); ResourceIndex++)
+		{
+			FFlareResourceDescription* Resource = Factory->GetOutputResource(ResourceIndex);
+			WorldHelper::FlareResourceStats *ResourceStats = &FindOrAddResourceStats(Stats, Resource);
+
+			int64 ProductionDuration = Factory->GetProductionDuration();
+			if (ProductionDuration == 0)
 			{
-				FFlareResourceDescription* Resource = Factory->GetInputResource(ResourceIndex);
-				WorldHelper::FlareResourceStats *ResourceStats = &WorldStats[Resource];
+				ProductionDuration = 10;
+			}
 
-				int64 ProductionDuration = Factory->GetProductionDuration();
+			float Flow = (float) Factory->GetOutputResourceQuantity(ResourceIndex) / float(ProductionDuration);
+			ResourceStats->Production+= Flow;
+		}
+	}
+}
 
-				float Flow = 0;
+TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats> SectorHelper::ComputeSectorResourceStats(UFlareSimulatedSector* Sector, bool IncludeStorage)
+{
+	TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats> WorldStats;
 
-				if (ProductionDuration == 0)
-				{
-					Flow = 1;
-				}
-				else
-				{
-					Flow = (float) Factory->GetInputResourceQuantity(ResourceIndex) / float(ProductionDuration);
-				}
+	// Init
+	for(int32 ResourceIndex = 0; ResourceIndex < Sector->GetGame()->GetResourceCatalog()->Resources.Num(); ResourceIndex++)
+	{
+		FFlareResourceDescription* Resource = &Sector->GetGame()->GetResourceCatalog()->Resources[ResourceIndex]->Data;
+		WorldHelper::FlareResourceStats ResourceStats;
+		ResourceStats.Production = 0;
+		ResourceStats.Consumption = 0;
+		ResourceStats.Balance = 0;
+		ResourceStats.Stock = 0;
+		ResourceStats.Capacity = 0;
 
-				ResourceStats->Consumption += Flow;
-			}
+		WorldStats.Add(Resource, ResourceStats);
+	}
 
-			// Ouput flow
-			for (int32 ResourceIndex = 0; ResourceIndex < Factory->GetOutputResourcesCount(); ResourceIndex++)
-			{
-				FFlareResourceDescription* Resource = Factory->GetOutputResource(ResourceIndex);
-				WorldHelper::FlareResourceStats *ResourceStats = &WorldStats[Resource];
+	// Stock and factory flows, maintained by the sector
+	const SectorResourceStatsCache& Cache = Sector->GetResourceStatsCache();
+	int32 PartCount = IncludeStorage ? 2 : 1;
 
-				int64 ProductionDuration = Factory->GetProductionDuration();
-				if (ProductionDuration == 0)
-				{
-					ProductionDuration = 10;
-				}
+	for (int32 Part = 0; Part < PartCount; Part++)
+	{
+		for (auto& Entry : Cache.Stock[Part])
+		{
+			WorldHelper::FlareResourceStats *ResourceStats = &WorldStats[Entry.Key];
+			ResourceStats->Stock += Entry.Value.Stock;
+			ResourceStats->Capacity += Entry.Value.Capacity;
+		}
 
-				float Flow = (float) Factory->GetOutputResourceQuantity(ResourceIndex) / float(ProductionDuration);
-				ResourceStats->Production+= Flow;
-			}
+		for (auto& Entry : Cache.Flows[Part])
+		{
+			WorldHelper::FlareResourceStats *ResourceStats = &WorldStats[Entry.Key];
+			ResourceStats->Production += Entry.Value.Production;
+			ResourceStats->Consumption += Entry.Value.Consumption;
 		}
 	}
 
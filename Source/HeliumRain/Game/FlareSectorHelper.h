@@ -19,6 +19,24 @@ struct SectorHelper
 		bool AllowUseNoTradeForMe = true;
 	};
 
+	/** Repair and refill needs of a spacecraft, before its repair and refill stocks */
+	struct FlareSpacecraftSupplyNeeds
+	{
+		UFlareSimulatedSpacecraft* Spacecraft = NULL;
+		float CurrentRepair = 0;
+		float TotalRepair = 0;
+		int64 RepairDuration = 0;
+		float CurrentRefill = 0;
+		float TotalRefill = 0;
+		int64 RefillDuration = 0;
+	};
+
+	/** Repair and refill needs of a group of spacecrafts, shared by the needs queries and the supply allocation */
+	struct FlareFleetSupplyPlan
+	{
+		TArray<FlareSpacecraftSupplyNeeds> Spacecrafts;
+	};
+
 	static UFlareSimulatedSpacecraft*  FindTradeStation(FlareTradeRequest Request);
 
 	static int32 Trade(UFlareSimulatedSpacecraft* SourceSpacecraft, UFlareSimulatedSpacecraft* DestinationSpacecraft, FFlareResourceDescription* Resource, int32 MaxQuantity, int64* TransactionPrice = NULL, UFlareTradeRoute* TradeRoute = nullptr);
@@ -31,6 +49,16 @@ struct SectorHelper
 
 	static bool HasShipRepairing(UFlareSimulatedSector* TargetSector, UFlareCompany* Company);
 
+	/** Compute the needs of the alive spacecrafts of a company, in one pass over their components */
+	static void ComputeFleetSupplyPlan(UFlareSimulatedSector* Sector, UFlareCompany* Company, bool OnlyPossible, FlareFleetSupplyPlan& OutPlan);
+
+	/** Compute the needs of the alive spacecrafts of a list, in one pass over their components */
+	static void ComputeFleetSupplyPlan(UFlareSimulatedSector* Sector, const TArray<UFlareSimulatedSpacecraft*>& Ships, bool OnlyPossible, FlareFleetSupplyPlan& OutPlan);
+
+	static void GetRepairFleetSupplyNeeds(const FlareFleetSupplyPlan& Plan, int32& CurrentNeededFleetSupply, int32& TotalNeededFleetSupply, int64& MaxDuration);
+
+	static void GetRefillFleetSupplyNeeds(const FlareFleetSupplyPlan& Plan, int32& CurrentNeededFleetSupply, int32& TotalNeededFleetSupply, int64& MaxDuration);
+
 	static void GetRepairFleetSupplyNeeds(UFlareSimulatedSector* Sector, UFlareCompany* Company, int32& CurrentNeededFleetSupply, int32& TotalNeededFleetSupply, int64& MaxDuration, bool OnlyPossible);
 
 	static void GetRefillFleetSupplyNeeds(UFlareSimulatedSector* Sector, UFlareCompany* Company, int32& CurrentNeededFleetSupply, int32& TotalNeededFleetSupply, int64& MaxDuration, bool OnlyPossible);
@@ -44,6 +72,12 @@ struct SectorHelper
 
 	static void RefillFleets(UFlareSimulatedSector* Sector, UFlareCompany* Company);
 
+	/** Repair the fleets of a company with a plan computed for this company with OnlyPossible set */
+	static void RepairFleets(UFlareSimulatedSector* Sector, UFlareCompany* Company, const FlareFleetSupplyPlan& Plan);
+
+	/** Refill the fleets of a company with a plan computed for this company with OnlyPossible set */
+	static void RefillFleets(UFlareSimulatedSector* Sector, UFlareCompany* Company, const FlareFleetSupplyPlan& Plan);
+
 	static void ConsumeFleetSupply(UFlareSimulatedSector* Sector, UFlareCompany* Company, int32 ConsumedFS, bool ForRepair);
 
 	static int32 GetArmyCombatPoints(UFlareSimulatedSector* Sector, bool ReduceByDamage);
@@ -54,6 +88,12 @@ struct SectorHelper
 
 	static TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats> ComputeSectorResourceStats(UFlareSimulatedSector* Sector, bool IncludeStorage);
 
+	/** Add the cargo stock and free input capacity of a spacecraft to resource stats */
+	static void AddSpacecraftStockStats(UFlareSimulatedSpacecraft* Spacecraft, TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats>& Stats);
+
+	/** Add the production and consumption flows of the factories of a spacecraft to resource stats */
+	static void AddSpacecraftFlowStats(UFlareSimulatedSpacecraft* Spacecraft, TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats>& Stats);
+
 	static int64 GetSellResourcePrice(UFlareSimulatedSector* Sector, FFlareResourceDescription* Resource, FFlareResourceUsage Usage);
 
 	static int64 GetBuyResourcePrice(UFlareSimulatedSector* Sector, FFlareResourceDescription* Resource, FFlareResourceUsage Usage);
@@ -42,6 +42,7 @@ UFlareSimulatedSector::UFlareSimulatedSector(const FObjectInitializer& ObjectIni
 	: Super(ObjectInitializer)
 {
 	PersistentStationIndex = 0;
+	SectorIndex = INDEX_NONE;
 }
 
 void UFlareSimulatedSector::Load(const FFlareSectorDescription* Description, const FFlareSectorSave& Data, const FFlareSectorOrbitParameters& OrbitParameters)
@@ -64,7 +65,9 @@ void UFlareSimulatedSector::Load(const FFlareSectorDescription* Description, con
 	SectorStations.Empty();
 	SectorChildStations.Empty();
 	SectorSpacecrafts.Empty();
+	CompanySpacecrafts.Empty();
 	SectorFleets.Empty();
+	InvalidateResourceStats();
 
 	FFlareCelestialBody* Body = Game->GetGameWorld()->GetPlanerarium()->FindCelestialBody(SectorOrbitParameters.CelestialBodyIdentifier);
 	if (Body)
@@ -110,7 +113,7 @@ void UFlareSimulatedSector::Load(const FFlareSectorDescription* Description, con
 		{
 			SectorSpacecrafts.Add(Spacecraft);
 		}
-
+		AddCompanySpacecraft(Spacecraft);
 	}
 
 
@@ -422,6 +425,7 @@ UFlareSimulatedSpacecraft* UFlareSimulatedSector::CreateSpacecraft(FFlareSpacecr
 	{
 		SectorSpacecrafts.Add(Spacecraft);
 	}
+	AddCompanySpacecraft(Spacecraft);
 
 	Spacecraft->SetCurrentSector(this);
 
@@ -476,6 +480,7 @@ void UFlareSimulatedSector::AddFleet(UFlareFleet* Fleet)
 		Fleet->GetShips()[ShipIndex]->SetCurrentSector(this);
 		SectorShips.AddUnique(Fleet->GetShips()[ShipIndex]);
 		SectorSpacecrafts.AddUnique(Fleet->GetShips()[ShipIndex]);
+		AddCompanySpacecraft(Fleet->GetShips()[ShipIndex]);
 	}
 }
 
@@ -511,12 +516,183 @@ void UFlareSimulatedSector::RetireFleet(UFlareFleet* Fleet)
 
 int UFlareSimulatedSector::RemoveSpacecraft(UFlareSimulatedSpacecraft* Spacecraft)
 {
+	RemoveCompanySpacecraft(Spacecraft);
 	SectorStations.Remove(Spacecraft);
 	SectorChildStations.Remove(Spacecraft);
 	SectorShips.Remove(Spacecraft);
 	return SectorSpacecrafts.Remove(Spacecraft);
 }
 
+void UFlareSimulatedSector::AddCompanySpacecraft(UFlareSimulatedSpacecraft* Spacecraft)
+{
+	// Complex elements are represented by their master station
+	if (Spacecraft->IsComplexElement())
+	{
+		return;
+	}
+
+	SectorCompanySpacecrafts& Bucket = CompanySpacecrafts.FindOrAdd(Spacecraft->GetCompany());
+	Bucket.Spacecrafts.AddUnique(Spacecraft);
+	InvalidateResourceStats();
+
+	if (Spacecraft->IsStation())
+	{
+		Bucket.Stations.AddUnique(Spacecraft);
+
+		if (Game->GetGameWorld())
+		{
+			Game->GetGameWorld()->InvalidateSectorStockCapacity(this);
+		}
+
+		if (People)
+		{
+			People->InvalidateConsumerMarket();
+		}
+	}
+	else
+	{
+		Bucket.Ships.AddUnique(Spacecraft);
+
+		if (Spacecraft->IsMilitary())
+		{
+			Bucket.MilitaryShips.AddUnique(Spacecraft);
+		}
+		else
+		{
+			Bucket.CargoShips.AddUnique(Spacecraft);
+		}
+	}
+}
+
+void UFlareSimulatedSector::RemoveCompanySpacecraft(UFlareSimulatedSpacecraft* Spacecraft)
+{
+	InvalidateResourceStats();
+
+	SectorCompanySpacecrafts* Bucket = CompanySpacecrafts.Find(Spacecraft->GetCompany());
+	if (!Bucket)
+	{
+		return;
+	}
+
+	Bucket->Spacecrafts.Remove(Spacecraft);
+	Bucket->Ships.Remove(Spacecraft);
+	Bucket->MilitaryShips.Remove(Spacecraft);
+	Bucket->CargoShips.Remove(Spacecraft);
+
+	if (Bucket->Stations.Remove(Spacecraft) > 0)
+	{
+		if (Game->GetGameWorld())
+		{
+			Game->GetGameWorld()->InvalidateSectorStockCapacity(this);
+		}
+
+		if (People)
+		{
+			People->InvalidateConsumerMarket();
+		}
+	}
+
+	if (Bucket->Spacecrafts.Num() == 0)
+	{
+		CompanySpacecrafts.Remove(Spacecraft->GetCompany());
+	}
+}
+
+SectorCompanySpacecrafts const& UFlareSimulatedSector::GetCompanySpacecrafts(UFlareCompany* Company) const
+{
+	static const SectorCompanySpacecrafts EmptyBucket;
+
+	const SectorCompanySpacecrafts* Bucket = CompanySpacecrafts.Find(Company);
+	return Bucket ? *Bucket : EmptyBucket;
+}
+
+void UFlareSimulatedSector::InvalidateResourceStock()
+{
+	ResourceStatsCache.StockValid = false;
+}
+
+void UFlareSimulatedSector::InvalidateResourceStats()
+{
+	ResourceStatsCache.StockValid = false;
+	ResourceStatsCache.FlowsDate = -1;
+	TradeCandidates.Empty();
+}
+
+const SectorResourceStatsCache& UFlareSimulatedSector::GetResourceStatsCache()
+{
+	if (!ResourceStatsCache.StockValid)
+	{
+		ResourceStatsCache.Stock[0].Empty();
+		ResourceStatsCache.Stock[1].Empty();
+
+		for (UFlareSimulatedSpacecraft* Spacecraft : SectorSpacecrafts)
+		{
+			int32 Part = Spacecraft->HasCapability(EFlareSpacecraftCapability::Storage) ? 1 : 0;
+			SectorHelper::AddSpacecraftStockStats(Spacecraft, ResourceStatsCache.Stock[Part]);
+		}
+
+		ResourceStatsCache.StockValid = true;
+	}
+
+	// Production time depends on the station damage, so flows are always updated daily
+	int64 Date = Game->GetGameWorld()->GetDate();
+	if (ResourceStatsCache.FlowsDate != Date)
+	{
+		ResourceStatsCache.Flows[0].Empty();
+		ResourceStatsCache.Flows[1].Empty();
+
+		for (UFlareSimulatedSpacecraft* Spacecraft : SectorSpacecrafts)
+		{
+			int32 Part = Spacecraft->HasCapability(EFlareSpacecraftCapability::Storage) ? 1 : 0;
+			SectorHelper::AddSpacecraftFlowStats(Spacecraft, ResourceStatsCache.Flows[Part]);
+		}
+
+		ResourceStatsCache.FlowsDate = Date;
+	}
+
+	return ResourceStatsCache;
+}
+
+const SectorTradeCandidates& UFlareSimulatedSector::GetTradeCandidates(FFlareResourceDescription* Resource)
+{
+	SectorTradeCandidates* Candidates = TradeCandidates.Find(Resource);
+	if (Candidates)
+	{
+		return *Candidates;
+	}
+
+	Candidates = &TradeCandidates.Add(Resource);
+
+	// Follow the sector station order, so that score ties are broken as in a full scan
+	for (UFlareSimulatedSpacecraft* Station : SectorStations)
+	{
+		// Hub usage follows the slot locks, so hubs are always candidates
+		if (Station->HasCapability(EFlareSpacecraftCapability::Storage))
+		{
+			Candidates->Buyers.Add(Station);
+			Candidates->Sellers.Add(Station);
+			continue;
+		}
+
+		FFlareResourceUsage Usage = Station->GetResourceUseType(Resource);
+
+		if (Usage.HasUsage(EFlareResourcePriceContext::FactoryInput)
+			|| Usage.HasUsage(EFlareResourcePriceContext::ConsumerConsumption)
+			|| Usage.HasUsage(EFlareResourcePriceContext::MaintenanceConsumption))
+		{
+			Candidates->Buyers.Add(Station);
+		}
+
+		if (Usage.HasUsage(EFlareResourcePriceContext::FactoryOutput)
+			|| Usage.HasUsage(EFlareResourcePriceContext::ConsumerConsumption))
+		{
+			Candidates->Sellers.Add(Station);
+		}
+	}
+
+	return *Candidates;
+}
+
 
 void UFlareSimulatedSector::SetSectorOrbitParameters(const FFlareSectorOrbitParameters& OrbitParameters)
 {
@@ -1065,15 +1241,7 @@ FText UFlareSimulatedSector::GetSectorBalanceText(bool ActiveOnly)
 
 int32 UFlareSimulatedSector::GetSectorCompanyStationCount(UFlareCompany* Company, bool IncludeCapture) const
 {
-	int32 CompanyStationCountInSector = 0;
-
-	for(UFlareSimulatedSpacecraft* Station : SectorStations)
-	{
-		if(Station->GetCompany() == Company)
-		{
-			++CompanyStationCountInSector;
-		}
-	}
+	int32 CompanyStationCountInSector = GetCompanySpacecrafts(Company).Stations.Num();
 
 	CompanyStationCountInSector += Company->GetCaptureOrderCountInSector(this);
 
@@ -1238,81 +1406,88 @@ FFlareSectorBattleState UFlareSimulatedSector::GetSectorBattleState(UFlareCompan
 	int FriendlyStationInCaptureCount = 0;
 	int FriendlyControllableShipCount = 0;
 
-	// Look at every spacecraft
-	for (int SpacecraftIndex = 0 ; SpacecraftIndex < GetSectorShips().Num(); SpacecraftIndex++)
+	// Look at every company present in the sector, hostility is evaluated once per company
+	for (auto& CompanyEntry : CompanySpacecrafts)
 	{
-		UFlareSimulatedSpacecraft* Spacecraft = GetSectorShips()[SpacecraftIndex];
-		UFlareCompany* OtherCompany = Spacecraft->GetCompany();
-
-		if (!Spacecraft->GetDamageSystem()->IsAlive())
-		{
-			continue;
-		}
+		UFlareCompany* OtherCompany = CompanyEntry.Key;
+		const SectorCompanySpacecrafts& Bucket = CompanyEntry.Value;
 
 		if (OtherCompany == Company)
 		{
-			FriendlySpacecraftCount++;
-			if (!Spacecraft->GetDamageSystem()->IsDisarmed())
+			for (UFlareSimulatedSpacecraft* Spacecraft : Bucket.Ships)
 			{
-				DangerousFriendlySpacecraftCount++;
-				if(!Spacecraft->IsReserve())
+				if (!Spacecraft->GetDamageSystem()->IsAlive())
 				{
-					DangerousFriendlyActiveSpacecraftCount++;
+					continue;
+				}
+
+				FriendlySpacecraftCount++;
+				if (!Spacecraft->GetDamageSystem()->IsDisarmed())
+				{
+					DangerousFriendlySpacecraftCount++;
+					if(!Spacecraft->IsReserve())
+					{
+						DangerousFriendlyActiveSpacecraftCount++;
+					}
+				}
+
+				if (Spacecraft->GetDamageSystem()->IsStranded())
+				{
+					CrippledFriendlySpacecraftCount++;
+				}
+
+				if(!Spacecraft->GetDamageSystem()->IsUncontrollable())
+				{
+					FriendlyControllableShipCount++;
 				}
 			}
 
-			if (Spacecraft->GetDamageSystem()->IsStranded())
+			for (UFlareSimulatedSpacecraft* Spacecraft : Bucket.Stations)
 			{
+				if (!Spacecraft->GetDamageSystem()->IsAlive())
+				{
+					continue;
+				}
+
+				FriendlySpacecraftCount++;
 				CrippledFriendlySpacecraftCount++;
-			}
 
-			if(!Spacecraft->GetDamageSystem()->IsUncontrollable())
-			{
-				FriendlyControllableShipCount++;
-			}
+				FriendlyStationCount++;
 
+				if (Spacecraft->IsBeingCaptured())
+				{
+					FriendlyStationInCaptureCount++;
+				}
+			}
 		}
 		else if (OtherCompany->GetWarState(Company) == EFlareHostility::Hostile)
 		{
-			HostileSpacecraftCount++;
-			if (!Spacecraft->GetDamageSystem()->IsDisarmed())
+			for (UFlareSimulatedSpacecraft* Spacecraft : Bucket.Ships)
 			{
-				DangerousHostileSpacecraftCount++;
-				if(!Spacecraft->IsReserve())
+				if (!Spacecraft->GetDamageSystem()->IsAlive())
 				{
-					DangerousHostileActiveSpacecraftCount++;
+					continue;
 				}
-			}
-		}
-	}
 
-	// Look at every station
-	for (int SpacecraftIndex = 0 ; SpacecraftIndex < GetSectorStations().Num(); SpacecraftIndex++)
-	{
-		UFlareSimulatedSpacecraft* Spacecraft = GetSectorStations()[SpacecraftIndex];
-		UFlareCompany* OtherCompany = Spacecraft->GetCompany();
-
-		if (!Spacecraft->GetDamageSystem()->IsAlive())
-		{
-			continue;
-		}
-
-		if (OtherCompany == Company)
-		{
-			FriendlySpacecraftCount++;
-			CrippledFriendlySpacecraftCount++;
-
-			FriendlyStationCount++;
+				HostileSpacecraftCount++;
+				if (!Spacecraft->GetDamageSystem()->IsDisarmed())
+				{
+					DangerousHostileSpacecraftCount++;
+					if(!Spacecraft->IsReserve())
+					{
+						DangerousHostileActiveSpacecraftCount++;
+					}
+				}
+			}
 
-			if (Spacecraft->IsBeingCaptured())
+			for (UFlareSimulatedSpacecraft* Spacecraft : Bucket.Stations)
 			{
-				FriendlyStationInCaptureCount++;
+				if (Spacecraft->GetDamageSystem()->IsAlive())
+				{
+					HostileSpacecraftCount++;
+				}
 			}
 		}
-		else if (OtherCompany->GetWarState(Company) == EFlareHostility::Hostile)
-		{
-			HostileSpacecraftCount++;
-		}
 	}
 
 	// Look at bombs if this is an active sector
@@ -1554,7 +1729,14 @@ void UFlareSimulatedSector::SwapPrices()
 
 void UFlareSimulatedSector::SetPreciseResourcePrice(FFlareResourceDescription* Resource, float NewPrice)
 {
+	int64 OldPrice = GetResourcePrice(Resource, EFlareResourcePriceContext::Default);
+
 	ResourcePrices[Resource] = FMath::Clamp(NewPrice, (float) Resource->MinPrice, (float) Resource->MaxPrice);
+
+	if (GetResourcePrice(Resource, EFlareResourcePriceContext::Default) != OldPrice)
+	{
+		ChangedPriceResources.AddUnique(Resource);
+	}
 }
 
 
@@ -2159,15 +2341,8 @@ int32 UFlareSimulatedSector::GetCompanyCapturePoints(UFlareCompany* Company) con
 {
 	int32 CapturePoints = 0;
 
-	for (int ShipIndex = 0; ShipIndex < SectorShips.Num(); ShipIndex++)
+	for (UFlareSimulatedSpacecraft* Ship : GetCompanySpacecrafts(Company).Ships)
 	{
-		UFlareSimulatedSpacecraft* Ship = SectorShips[ShipIndex];
-
-		if (Ship->GetCompany() != Company)
-		{
-			continue;
-		}
-
 		if (Ship->GetDamageSystem()->IsDisarmed())
 		{
 			continue;
@@ -6,6 +6,7 @@
 #include "../Data/FlareAsteroidCatalog.h"
 #include "../Spacecrafts/FlareBomb.h"
 #include "../Economy/FlarePeople.h"
+#include "FlareWorldHelper.h"
 #include "../Player/FlareSoundManager.h"
 #include "FlareSimulatedSector.generated.h"
 
@@ -352,6 +353,42 @@ struct FFlareStationSpawnParameters
 	}
 };
 
+/** Spacecrafts of one company in a sector, split by role */
+struct SectorCompanySpacecrafts
+{
+	TArray<UFlareSimulatedSpacecraft*> Spacecrafts;
+	TArray<UFlareSimulatedSpacecraft*> Ships;
+	TArray<UFlareSimulatedSpacecraft*> MilitaryShips;
+	TArray<UFlareSimulatedSpacecraft*> CargoShips;
+	TArray<UFlareSimulatedSpacecraft*> Stations;
+};
+
+/** Spacecraft part of the sector resource stats, split between regular (0) and storage (1) spacecrafts */
+struct SectorResourceStatsCache
+{
+	/** Cargo stock and free input capacity, updated after a cargo or spacecraft change */
+	TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats> Stock[2];
+	bool StockValid;
+
+	/** Factory production and consumption, updated daily or after a production change */
+	TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats> Flows[2];
+	int64 FlowsDate;
+
+	SectorResourceStatsCache()
+		: StockValid(false)
+		, FlowsDate(-1)
+	{}
+};
+
+/** Stations that may trade a resource, in the sector station order */
+struct SectorTradeCandidates
+{
+	/** Stations that may take the resource as input, consumption or hub input */
+	TArray<UFlareSimulatedSpacecraft*> Buyers;
+
+	/** Stations that may provide the resource as output, consumption or hub output */
+	TArray<UFlareSimulatedSpacecraft*> Sellers;
+};
 
 UCLASS()
 class HELIUMRAIN_API UFlareSimulatedSector : public UObject
@@ -408,6 +445,12 @@ public:
 
 	void SetSectorOrbitParameters(const FFlareSectorOrbitParameters& OrbitParameters);
 
+	/** Set the dense index of this sector in the world sector list */
+	void SetSectorIndex(int32 Index)
+	{
+		SectorIndex = Index;
+	}
+
 	/** Check whether we can build a station, understand why if not */
 	bool CanBuildStation(FFlareSpacecraftDescription* StationDescription, UFlareCompany* Company, TArray<FText>& OutReason,
 		bool IgnoreCost = false, bool InComplex = false, bool InComplexSpecial = false);
@@ -451,8 +494,26 @@ public:
 
 	TMap<FFlareResourceDescription*, int32> DistributeResources(TMap<FFlareResourceDescription*, int32> Resources, UFlareSimulatedSpacecraft* Source, UFlareCompany* TargetCompany, bool DryRun);
 
+	/** Mark the cached stock stats as outdated, after a cargo change */
+	void InvalidateResourceStock();
+
+	/** Mark all the cached resource stats as outdated, after a spacecraft or production change */
+	void InvalidateResourceStats();
+
+	/** Get the spacecraft part of the resource stats, updated if needed */
+	const SectorResourceStatsCache& GetResourceStatsCache();
+
+	/** Get the stations that may trade this resource, updated after a spacecraft or production change */
+	const SectorTradeCandidates& GetTradeCandidates(FFlareResourceDescription* Resource);
+
 protected:
 
+	/** Register a spacecraft in its company bucket */
+	void AddCompanySpacecraft(UFlareSimulatedSpacecraft* Spacecraft);
+
+	/** Unregister a spacecraft from its company bucket */
+	void RemoveCompanySpacecraft(UFlareSimulatedSpacecraft* Spacecraft);
+
     /*----------------------------------------------------
         Protected data
     ----------------------------------------------------*/
@@ -463,6 +524,9 @@ protected:
 	TArray<UFlareSimulatedSpacecraft*>      SectorChildStations;
 	TArray<UFlareSimulatedSpacecraft*>      SectorShips;
 	TArray<UFlareSimulatedSpacecraft*>      SectorSpacecrafts;
+	TMap<UFlareCompany*, SectorCompanySpacecrafts> CompanySpacecrafts;
+	SectorResourceStatsCache                ResourceStatsCache;
+	TMap<FFlareResourceDescription*, SectorTradeCandidates> TradeCandidates;
 
 	TArray<UFlareFleet*>                    SectorFleets;
 
@@ -470,6 +534,7 @@ protected:
 	UFlarePeople*							People;
 
 	int32                                   PersistentStationIndex;
+	int32                                   SectorIndex;
 	float									LightRatio;
 
 	AFlareGame*                             Game;
@@ -479,6 +544,7 @@ protected:
 	const FFlareSectorDescription*          SectorDescription;
 	TMap<FFlareResourceDescription*, float> ResourcePrices;
 	TMap<FFlareResourceDescription*, FFlareFloatBuffer> LastResourcePrices;
+	TArray<FFlareResourceDescription*>      ChangedPriceResources;
 
 public:
 
@@ -501,6 +567,12 @@ public:
 
 	FString GetSectorCode();
 
+	/** Get the dense index of this sector, INDEX_NONE for travel sectors */
+	inline int32 GetSectorIndex() const
+	{
+		return SectorIndex;
+	}
+
 	inline const FFlareSectorDescription* GetDescription() const
 	{
 		return SectorDescription;
@@ -534,6 +606,14 @@ public:
 		return SectorSpacecrafts;
 	}
 
+	/** Get the spacecrafts of a company in this sector, split by role */
+	SectorCompanySpacecrafts const& GetCompanySpacecrafts(UFlareCompany* Company) const;
+
+	inline TMap<UFlareCompany*, SectorCompanySpacecrafts> const& GetSpacecraftsByCompany() const
+	{
+		return CompanySpacecrafts;
+	}
+
 	inline TArray<UFlareFleet*>& GetSectorFleets()
 	{
 		return SectorFleets;
@@ -573,6 +653,17 @@ public:
 
 	void SetPreciseResourcePrice(FFlareResourceDescription* Resource, float NewPrice);
 
+	/** Get the resources whose price changed since the last clear */
+	inline TArray<FFlareResourceDescription*> const& GetChangedPriceResources() const
+	{
+		return ChangedPriceResources;
+	}
+
+	void ClearChangedPriceResources()
+	{
+		ChangedPriceResources.Empty();
+	}
+
 	void UpdateFleetSupplyConsumptionStats();
 
 	void OnFleetSupplyConsumed(int32 Quantity);
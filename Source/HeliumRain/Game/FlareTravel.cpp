@@ -374,6 +374,8 @@ void UFlareTravel::ChangeDestination(UFlareSimulatedSector* NewDestinationSector
 	// TODO intelligent travel remaining duration change
 	TravelData.DepartureDate = Game->GetGameWorld()->GetDate();
 	GenerateTravelDuration();
+
+	Game->GetGameWorld()->InvalidateIncomingPlayerEnemy();
 }
 
 bool UFlareTravel::CanChangeDestination()
@@ -15,6 +15,7 @@
 #include "FlareFleet.h"
 #include "FlareBattle.h"
 #include "AI/FlareAITradeHelper.h"
+#include "Log/FlareEconomyRecorder.h"
 
 #include "../Quests/FlareQuest.h"
 #include "../Quests/FlareQuestCondition.h"
@@ -30,6 +31,8 @@
 
 UFlareWorld::UFlareWorld(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
+	, IncomingPlayerEnemyIndexValid(false)
+	, IncomingThreatEventsValid(false)
 {
 }
 
@@ -38,6 +41,14 @@ void UFlareWorld::Load(const FFlareWorldSave& Data)
 	FLOG("UFlareWorld::Load");
 	Game = Cast<AFlareGame>(GetOuter());
     WorldData = Data;
+	InvalidateIncomingPlayerEnemy();
+	ShipCaptureCandidates.Empty();
+	StationCaptureCandidates.Empty();
+	Shipyards.Empty();
+	SectorStockCapacities.Empty();
+	FactoryWakeQueue.Empty();
+	EconomyRecorder.Reset();
+	InvalidateWorldResourceStats();
 
 	// Init planetarium
 	Planetarium = NewObject<UFlareSimulatedPlanetarium>(this, UFlareSimulatedPlanetarium::StaticClass());
@@ -113,6 +124,19 @@ void UFlareWorld::Load(const FFlareWorldSave& Data)
 		LoadTravel(WorldData.TravelData[i]);
 	}
 
+	// Stations with pending capture orders are capture candidates
+	for (UFlareCompany* Company : Companies)
+	{
+		for (FName StationImmatriculation : Company->GetCaptureOrders())
+		{
+			UFlareSimulatedSpacecraft* Station = FindSpacecraft(StationImmatriculation);
+			if (Station)
+			{
+				AddCaptureCandidate(Station);
+			}
+		}
+	}
+
 	WorldMoneyReferenceInit = false;
 }
 
@@ -145,6 +169,7 @@ UFlareSimulatedSector* UFlareWorld::LoadSector(const FFlareSectorDescription* De
 
 	// Create the new sector
 	Sector = NewObject<UFlareSimulatedSector>(this, UFlareSimulatedSector::StaticClass(), SectorData.Identifier);
+	Sector->SetSectorIndex(Sectors.Num());
 	Sector->Load(Description, SectorData, OrbitParameters);
 	Sectors.AddUnique(Sector);
 
@@ -162,6 +187,7 @@ UFlareTravel* UFlareWorld::LoadTravel(const FFlareTravelSave& TravelData)
 	Travel = NewObject<UFlareTravel>(this, UFlareTravel::StaticClass());
 	Travel->Load(TravelData);
 	Travels.AddUnique(Travel);
+	InvalidateIncomingPlayerEnemy();
 
 	//FLOGV("UFlareWorld::LoadTravel : loaded travel for fleet '%s'", *Travel->GetFleet()->GetFleetName().ToString());
 
@@ -543,6 +569,10 @@ void UFlareWorld::Simulate()
 	IdleShips.Print();
 #endif
 
+	// World stats are shared by all AI companies
+	InvalidateWorldResourceStats();
+	FactoryScoreTerms.Empty();
+
 	// AI. Play them in random order
 	TArray<UFlareCompany*> CompaniesToSimulateAI = Companies;
 	while(CompaniesToSimulateAI.Num())
@@ -580,6 +610,10 @@ void UFlareWorld::Simulate()
 	 */
 	FLOG("* Simulate > New day");
 
+	// Menus and tools read the world stats of the new day
+	InvalidateWorldResourceStats();
+
+
 	WorldData.Date++;
 
 	// Write FS consumption stats
@@ -708,9 +742,33 @@ void UFlareWorld::Simulate()
 		}
 	}
 
+	// Wake up factories due today, or earlier if the date was forced
+	for (auto WakeEntry = FactoryWakeQueue.CreateIterator(); WakeEntry; ++WakeEntry)
+	{
+		if (WakeEntry.Key() > GetDate())
+		{
+			continue;
+		}
+
+		for (UFlareFactory* Factory : WakeEntry.Value())
+		{
+			// Factories woken earlier by a state change are still queued under their old date
+			if (Factory->IsSleeping() && Factory->GetWakeDate() <= GetDate())
+			{
+				Factory->WakeUp();
+			}
+		}
+
+		WakeEntry.RemoveCurrent();
+	}
+
 	for (int FactoryIndex = 0; FactoryIndex < Factories.Num(); FactoryIndex++)
 	{
-		Factories[FactoryIndex]->Simulate();
+		UFlareFactory* Factory = Factories[FactoryIndex];
+		if (!Factory->IsSleeping())
+		{
+			Factory->Simulate();
+		}
 	}
 
 
@@ -756,6 +814,9 @@ void UFlareWorld::Simulate()
 	{
 		TravelsToProcess[TravelIndex]->Simulate();
 	}
+
+	// Remaining travel durations changed
+	InvalidateIncomingPlayerEnemy();
 	
 	FLOG("* Simulate > Prices");
 	// Price variation.
@@ -790,9 +851,15 @@ void UFlareWorld::Simulate()
 	// Lets AI check if in battle
 	CheckAIBattleState();
 
+	// Revalue company assets after price changes
 	for (UFlareCompany* Company : Companies)
 	{
-		Company->InvalidateCompanyValueCache();
+		Company->UpdateCompanyValuePrices();
+	}
+
+	for (UFlareSimulatedSector* Sector : Sectors)
+	{
+		Sector->ClearChangedPriceResources();
 	}
 
 	
@@ -803,6 +870,20 @@ void UFlareWorld::Simulate()
 
 	GameLog::DaySimulated(WorldData.Date);
 
+	// Economy time series
+	if (UFlareGameTools::RecordEconomy)
+	{
+		if (!EconomyRecorder.IsValid())
+		{
+			EconomyRecorder = MakeShareable(new FFlareEconomyRecorder(Game->GetPC()->GetPlayerData()->UUID));
+		}
+		EconomyRecorder->RecordDay(this);
+	}
+	else
+	{
+		EconomyRecorder.Reset();
+	}
+
 	// Check recovery
 	{
 		// Check if it the last ship
@@ -900,44 +981,274 @@ void UFlareWorld::UpdateStorageLocks()
 	}
 }
 
+void UFlareWorld::AddCaptureCandidate(UFlareSimulatedSpacecraft* Spacecraft)
+{
+	// Complex elements are captured with their master station
+	if (Spacecraft->IsComplexElement())
+	{
+		return;
+	}
+
+	if (Spacecraft->IsStation())
+	{
+		StationCaptureCandidates.Add(Spacecraft);
+	}
+	else
+	{
+		ShipCaptureCandidates.Add(Spacecraft);
+	}
+}
+
+void UFlareWorld::RemoveCaptureCandidate(UFlareSimulatedSpacecraft* Spacecraft)
+{
+	ShipCaptureCandidates.Remove(Spacecraft);
+	StationCaptureCandidates.Remove(Spacecraft);
+}
+
+const TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats>& UFlareWorld::GetWorldResourceStats(bool IncludeStorage)
+{
+	if (IncludeStorage)
+	{
+		if (!WorldResourceStatsValid)
+		{
+			WorldResourceStats = WorldHelper::ComputeWorldResourceStats(Game, true);
+			WorldResourceStatsValid = true;
+		}
+		return WorldResourceStats;
+	}
+	else
+	{
+		if (!WorldResourceStatsWithoutStorageValid)
+		{
+			WorldResourceStatsWithoutStorage = WorldHelper::ComputeWorldResourceStats(Game, false);
+			WorldResourceStatsWithoutStorageValid = true;
+		}
+		return WorldResourceStatsWithoutStorage;
+	}
+}
+
+void UFlareWorld::InvalidateWorldResourceStats()
+{
+	WorldResourceStatsValid = false;
+	WorldResourceStatsWithoutStorageValid = false;
+}
+
+const WorldHelper::FlareFactoryScoreTerms& UFlareWorld::GetFactoryScoreTerms(UFlareSimulatedSector* Sector, FFlareFactoryDescription* FactoryDescription)
+{
+	TMap<FFlareFactoryDescription*, WorldHelper::FlareFactoryScoreTerms>& SectorTerms = FactoryScoreTerms.FindOrAdd(Sector);
+
+	WorldHelper::FlareFactoryScoreTerms* Terms = SectorTerms.Find(FactoryDescription);
+	if (!Terms)
+	{
+		Terms = &SectorTerms.Add(FactoryDescription, WorldHelper::ComputeFactoryScoreTerms(Sector, FactoryDescription, GetWorldResourceStats()));
+	}
+
+	return *Terms;
+}
+
+const WorldHelper::FlareSectorStockCapacity& UFlareWorld::GetSectorStockCapacity(UFlareSimulatedSector* Sector)
+{
+	WorldHelper::FlareSectorStockCapacity* StockCapacity = SectorStockCapacities.Find(Sector);
+	if (!StockCapacity)
+	{
+		StockCapacity = &SectorStockCapacities.Add(Sector, WorldHelper::ComputeSectorStockCapacity(Sector));
+	}
+
+	return *StockCapacity;
+}
+
+void UFlareWorld::InvalidateSectorStockCapacity(UFlareSimulatedSector* Sector)
+{
+	SectorStockCapacities.Remove(Sector);
+}
+
+void UFlareWorld::UpdateShipyard(UFlareSimulatedSpacecraft* Station)
+{
+	// Complex elements take orders through their master station
+	bool IsRegistered = Station->IsStation()
+		&& !Station->IsComplexElement()
+		&& !Station->IsDestroyed()
+		&& Station->IsShipyard();
+
+	WorldShipyard* Shipyard = Shipyards.FindByPredicate([Station](const WorldShipyard& Entry)
+	{
+		return Entry.Station == Station;
+	});
+
+	if (Shipyard)
+	{
+		if (IsRegistered)
+		{
+			Shipyard->QueueStateDate = -1;
+		}
+		else
+		{
+			RemoveShipyard(Station);
+		}
+	}
+	else if (IsRegistered)
+	{
+		WorldShipyard NewShipyard;
+		NewShipyard.Station = Station;
+		Shipyards.Add(NewShipyard);
+	}
+}
+
+void UFlareWorld::RemoveShipyard(UFlareSimulatedSpacecraft* Station)
+{
+	Shipyards.RemoveAll([Station](const WorldShipyard& Entry)
+	{
+		return Entry.Station == Station;
+	});
+}
+
+void UFlareWorld::InvalidateShipyardQueue(UFlareSimulatedSpacecraft* Station)
+{
+	for (WorldShipyard& Shipyard : Shipyards)
+	{
+		if (Shipyard.Station == Station)
+		{
+			Shipyard.QueueStateDate = -1;
+			break;
+		}
+	}
+
+	// Idle shipyards count their next order in the sector resource stats
+	if (Station->GetCurrentSector())
+	{
+		Station->GetCurrentSector()->InvalidateResourceStats();
+	}
+}
+
+void UFlareWorld::GetCompanyShipyards(UFlareCompany* Company, TArray<UFlareSimulatedSpacecraft*>& OutShipyards)
+{
+	TArray<WorldShipyard*> CompanyShipyards;
+
+	for (WorldShipyard& Shipyard : Shipyards)
+	{
+		UFlareSimulatedSpacecraft* Station = Shipyard.Station;
+
+		if (!Company->IsKnownSector(Station->GetCurrentSector()))
+		{
+			continue;
+		}
+
+		if (Company->GetWarState(Station->GetCompany()) == EFlareHostility::Hostile)
+		{
+			continue;
+		}
+
+		UpdateShipyardQueue(Shipyard);
+		CompanyShipyards.Add(&Shipyard);
+	}
+
+	CompanyShipyards.StableSort([](const WorldShipyard& A, const WorldShipyard& B)
+	{
+		return A.EstimatedCompletionDate < B.EstimatedCompletionDate;
+	});
+
+	OutShipyards.Reset(CompanyShipyards.Num());
+	for (WorldShipyard* Shipyard : CompanyShipyards)
+	{
+		OutShipyards.Add(Shipyard->Station);
+	}
+}
+
+void UFlareWorld::UpdateShipyardQueue(WorldShipyard& Shipyard)
+{
+	if (Shipyard.QueueStateDate == WorldData.Date)
+	{
+		return;
+	}
+
+	UFlareSimulatedSpacecraft* Station = Shipyard.Station;
+	TArray<FFlareShipyardOrderSave>& OrderQueue = Station->GetShipyardOrderQueue();
+	TArray<FFlareShipyardOrderSave> OngoingProduction = Station->GetOngoingProductionList();
+
+	// Remaining ongoing production
+	int64 RemainingDuration = 0;
+	for (FFlareShipyardOrderSave& Production : OngoingProduction)
+	{
+		RemainingDuration = FMath::Max(RemainingDuration, (int64) Production.RemainingProductionDuration);
+	}
+
+	// Last queued order
+	if (OrderQueue.Num() > 0)
+	{
+		int32 LastOrderIndex = OrderQueue.Num() - 1;
+		FName LastShipClass = OrderQueue[LastOrderIndex].ShipClass;
+		int64 LastOrderDuration = Station->GetEstimatedQueueAndProductionDuration(LastShipClass, LastOrderIndex) + Station->GetShipProductionTime(LastShipClass);
+		RemainingDuration = FMath::Max(RemainingDuration, LastOrderDuration);
+	}
+
+	Shipyard.EstimatedCompletionDate = WorldData.Date + RemainingDuration;
+	Shipyard.QueueStateDate = WorldData.Date;
+}
+
+void UFlareWorld::GetCaptureCandidatesBySector(const TSet<UFlareSimulatedSpacecraft*>& Candidates, TMap<UFlareSimulatedSector*, TArray<UFlareSimulatedSpacecraft*>>& CandidatesBySector) const
+{
+	for (UFlareSimulatedSpacecraft* Spacecraft : Candidates)
+	{
+		if (Spacecraft->GetCurrentSector())
+		{
+			CandidatesBySector.FindOrAdd(Spacecraft->GetCurrentSector()).Add(Spacecraft);
+		}
+	}
+}
+
 void UFlareWorld::ProcessShipCapture()
 {
 	TArray<UFlareSimulatedSpacecraft*> ShipToCapture;
 
+	// Forget ships that are not harpooned anymore
+	for (auto CandidateIt = ShipCaptureCandidates.CreateIterator(); CandidateIt; ++CandidateIt)
+	{
+		if (!(*CandidateIt)->IsHarpooned() || (*CandidateIt)->IsDestroyed())
+		{
+			CandidateIt.RemoveCurrent();
+		}
+	}
+
+	TMap<UFlareSimulatedSector*, TArray<UFlareSimulatedSpacecraft*>> CandidatesBySector;
+	GetCaptureCandidatesBySector(ShipCaptureCandidates, CandidatesBySector);
+
 	for (int SectorIndex = 0; SectorIndex < Sectors.Num(); SectorIndex++)
 	{
 		UFlareSimulatedSector* Sector = Sectors[SectorIndex];
+		TArray<UFlareSimulatedSpacecraft*>* SectorCandidates = CandidatesBySector.Find(Sector);
 
-		for (int32 SpacecraftIndex = 0; SpacecraftIndex < Sector->GetSectorShips().Num(); SpacecraftIndex++)
+		// Only sectors with harpooned ships
+		if (!SectorCandidates)
 		{
-			UFlareSimulatedSpacecraft* Spacecraft = Sector->GetSectorShips()[SpacecraftIndex];
+			continue;
+		}
 
-			if(Spacecraft->IsHarpooned()) {
-				// Capture the ship if the following condition is ok :
-				// - The harpoon owner must be at war this the ship owner
-				// - The harpoon owner must in won state : military presence only for him
+		for (UFlareSimulatedSpacecraft* Spacecraft : *SectorCandidates)
+		{
+			// Capture the ship if the following condition is ok :
+			// - The harpoon owner must be at war this the ship owner
+			// - The harpoon owner must in won state : military presence only for him
 
-				UFlareCompany* HarpoonOwner = Spacecraft->GetHarpoonCompany();
+			UFlareCompany* HarpoonOwner = Spacecraft->GetHarpoonCompany();
 
 
-				FFlareSectorBattleState  HarpoonOwnerBattleState = Sector->GetSectorBattleState(HarpoonOwner);
-				FFlareSectorBattleState  SpacecraftOwnerBattleState = Sector->GetSectorBattleState(Spacecraft->GetCompany());
+			FFlareSectorBattleState  HarpoonOwnerBattleState = Sector->GetSectorBattleState(HarpoonOwner);
+			FFlareSectorBattleState  SpacecraftOwnerBattleState = Sector->GetSectorBattleState(Spacecraft->GetCompany());
 
 
-				if(HarpoonOwner
-						&& HarpoonOwner->GetWarState(Spacecraft->GetCompany()) == EFlareHostility::Hostile
-						&& !HarpoonOwnerBattleState.HasDanger)
-				{
-					// If battle won state, this mean the Harpoon owner has at least one dangerous ship
-					// This also mean that no company at war with this company has a military ship
+			if(HarpoonOwner
+					&& HarpoonOwner->GetWarState(Spacecraft->GetCompany()) == EFlareHostility::Hostile
+					&& !HarpoonOwnerBattleState.HasDanger)
+			{
+				// If battle won state, this mean the Harpoon owner has at least one dangerous ship
+				// This also mean that no company at war with this company has a military ship
 
-					ShipToCapture.Add(Spacecraft);
-					// Need to keep the harpoon for capture process
-				}
-				else if(!SpacecraftOwnerBattleState.HasDanger)
-				{
-					Spacecraft->SetHarpooned(NULL);
-				}
+				ShipToCapture.Add(Spacecraft);
+				// Need to keep the harpoon for capture process
+			}
+			else if(!SpacecraftOwnerBattleState.HasDanger)
+			{
+				Spacecraft->SetHarpooned(NULL);
 			}
 		}
 	}
@@ -1036,15 +1347,48 @@ void UFlareWorld::ProcessStationCapture()
 	TArray<UFlareSimulatedSpacecraft*> StationToCapture;
 	TArray<UFlareCompany*> StationCapturer;
 
+	// Forget stations that are neither being captured nor ordered to be captured
+	for (auto CandidateIt = StationCaptureCandidates.CreateIterator(); CandidateIt; ++CandidateIt)
+	{
+		UFlareSimulatedSpacecraft* Station = *CandidateIt;
+		bool IsContested = Station->IsBeingCaptured();
+
+		for (int CompanyIndex = 0; !IsContested && CompanyIndex < Companies.Num(); CompanyIndex++)
+		{
+			IsContested = Companies[CompanyIndex]->WantCapture(Station);
+		}
+
+		if (Station->IsDestroyed() || !IsContested)
+		{
+			CandidateIt.RemoveCurrent();
+		}
+	}
+
+	TMap<UFlareSimulatedSector*, TArray<UFlareSimulatedSpacecraft*>> CandidatesBySector;
+	GetCaptureCandidatesBySector(StationCaptureCandidates, CandidatesBySector);
+
 	for (int SectorIndex = 0; SectorIndex < Sectors.Num(); SectorIndex++)
 	{
 		UFlareSimulatedSector* Sector = Sectors[SectorIndex];
+		TArray<UFlareSimulatedSpacecraft*>* SectorCandidates = CandidatesBySector.Find(Sector);
 
-		for (int32 SpacecraftIndex = 0; SpacecraftIndex < Sector->GetSectorStations().Num(); SpacecraftIndex++)
+		// Only sectors with stations being captured or ordered to be captured
+		if (!SectorCandidates)
 		{
-			UFlareSimulatedSpacecraft* Spacecraft = Sector->GetSectorStations()[SpacecraftIndex];
+			continue;
+		}
 
-			FFlareSectorBattleState StationOwnerBattleState = Sector->GetSectorBattleState(Spacecraft->GetCompany());
+		// The battle state only depends on the station owner
+		TMap<UFlareCompany*, FFlareSectorBattleState> OwnerBattleStates;
+
+		for (UFlareSimulatedSpacecraft* Spacecraft : *SectorCandidates)
+		{
+			UFlareCompany* Owner = Spacecraft->GetCompany();
+			if (!OwnerBattleStates.Contains(Owner))
+			{
+				OwnerBattleStates.Add(Owner, Sector->GetSectorBattleState(Owner));
+			}
+			FFlareSectorBattleState StationOwnerBattleState = OwnerBattleStates[Owner];
 
 			if (!StationOwnerBattleState.HasDanger)
 			{
@@ -1263,17 +1607,28 @@ void UFlareWorld::FastForward()
 	Simulate();
 }
 
-TMap<IncomingKey, IncomingValue> UFlareWorld::GetIncomingPlayerEnemy()
+const TMap<IncomingKey, IncomingValue>& UFlareWorld::GetIncomingPlayerEnemy()
+{
+	if (!IncomingPlayerEnemyIndexValid)
+	{
+		UpdateIncomingPlayerEnemy();
+	}
+
+	return IncomingPlayerEnemyIndex;
+}
+
+void UFlareWorld::UpdateIncomingPlayerEnemy()
 {
 	// List sector with player possesion
-	TArray<UFlareSimulatedSector*> PlayerSectors;
-	TMap<IncomingKey, IncomingValue> IncomingMap;
+	TSet<UFlareSimulatedSector*> PlayerSectors;
+	TMap<IncomingKey, IncomingValue>& IncomingMap = IncomingPlayerEnemyIndex;
+	IncomingMap.Empty();
 
 	UFlareCompany* PlayerCompany = GetGame()->GetPC()->GetCompany();
 
 	for(UFlareSimulatedSpacecraft* Spacecraft : GetGame()->GetPC()->GetCompany()->GetCompanySpacecrafts())
 	{
-		PlayerSectors.AddUnique(Spacecraft->GetCurrentSector());
+		PlayerSectors.Add(Spacecraft->GetCurrentSector());
 	}
 
 	// List dangerous travels
@@ -1319,7 +1674,8 @@ TMap<IncomingKey, IncomingValue> UFlareWorld::GetIncomingPlayerEnemy()
 		Value.HeavyShipCount += Travel->GetFleet()->GetMilitaryShipCountBySize(EFlarePartSize::L);
 	}
 
-	return IncomingMap;
+	IncomingPlayerEnemyIndexValid = true;
+	IncomingThreatEventsValid = false;
 }
 
 void UFlareWorld::ProcessIncomingPlayerEnemy()
@@ -1334,7 +1690,7 @@ void UFlareWorld::ProcessIncomingPlayerEnemy()
 	FText MultipleShips = LOCTEXT("ShipPlural", "ships");
 
 
-	TMap<IncomingKey, IncomingValue> IncomingMap = GetIncomingPlayerEnemy();
+	const TMap<IncomingKey, IncomingValue>& IncomingMap = GetIncomingPlayerEnemy();
 
 	bool OneDayNotificationHide = true;
 	bool MutipleDaysNotificationHide = true;
@@ -1652,6 +2008,12 @@ void UFlareWorld::ClearFactories(UFlareSimulatedSpacecraft *ParentSpacecraft)
 		if (Factory->GetParent() == ParentSpacecraft)
 		{
 			Factories.RemoveAt(FactoryIndex);
+
+			// The queue doesn't hold references, don't leave a factory behind
+			for (auto& WakeEntry : FactoryWakeQueue)
+			{
+				WakeEntry.Value.Remove(Factory);
+			}
 		}
 	}
 }
@@ -1661,6 +2023,11 @@ void UFlareWorld::AddFactory(UFlareFactory* Factory)
 	Factories.Add(Factory);
 }
 
+void UFlareWorld::ScheduleFactoryWake(UFlareFactory* Factory, int64 Date)
+{
+	FactoryWakeQueue.FindOrAdd(Date).AddUnique(Factory);
+}
+
 
 UFlareTravel* UFlareWorld::	StartTravel(UFlareFleet* TravelingFleet, UFlareSimulatedSector* DestinationSector, bool Force)
 {
@@ -1745,6 +2112,13 @@ UFlareTravel* UFlareWorld::	StartTravel(UFlareFleet* TravelingFleet, UFlareSimul
 void UFlareWorld::DeleteTravel(UFlareTravel* Travel)
 {
 	Travels.Remove(Travel);
+	InvalidateIncomingPlayerEnemy();
+}
+
+void UFlareWorld::InvalidateIncomingPlayerEnemy()
+{
+	IncomingPlayerEnemyIndexValid = false;
+	IncomingThreatEventsValid = false;
 }
 
 /*----------------------------------------------------
@@ -1961,48 +2335,56 @@ TArray<FFlareIncomingEvent> UFlareWorld::GetIncomingEvents()
 		(UnknownShipCount > 1) ? MultipleShips : SingleShip);
 	};
 
-	// List incoming threats first
-	TMap<IncomingKey, IncomingValue> IncomingMap = GetIncomingPlayerEnemy();
-	for (auto Entry : IncomingMap)
+	// List incoming threats first, only formatted again when the threat index changed
+	const TMap<IncomingKey, IncomingValue>& IncomingMap = GetIncomingPlayerEnemy();
+	if (!IncomingThreatEventsValid)
 	{
-		UFlareCompany* Company = Entry.Key.Company;
-		UFlareSimulatedSector* Sector = Entry.Key.DestinationSector;
-		int32 EnemyValue = Entry.Value.CombatValue;
-		int64 RemainingDuration = Entry.Key.RemainingDuration;
+		IncomingThreatEvents.Empty();
 
-		if (RemainingDuration <=1 || PlayerCompany->IsTechnologyUnlocked("early-warning"))
+		for (auto& Entry : IncomingMap)
 		{
+			UFlareCompany* Company = Entry.Key.Company;
+			UFlareSimulatedSector* Sector = Entry.Key.DestinationSector;
+			int32 EnemyValue = Entry.Value.CombatValue;
+			int64 RemainingDuration = Entry.Key.RemainingDuration;
 
-			FText TravelText;
-			FText TravelPartText = FText::Format(LOCTEXT("ThreatTextTravelPart", "Traveling to {0} ({1} left)"),
-					Sector->GetSectorName(),
-					UFlareGameTools::FormatDate(RemainingDuration, 1));
-
-			if (PlayerCompany->IsTechnologyUnlocked("advanced-radar"))
+			if (RemainingDuration <=1 || PlayerCompany->IsTechnologyUnlocked("early-warning"))
 			{
 
-				TravelText = FText::Format(LOCTEXT("ThreatTextAdvancedFormat", "\u2022 <WarningText>{0} (Combat value of {1})</>\n    <WarningText>{3}</>\n    <WarningText>{2}</>"),
+				FText TravelText;
+				FText TravelPartText = FText::Format(LOCTEXT("ThreatTextTravelPart", "Traveling to {0} ({1} left)"),
+						Sector->GetSectorName(),
+						UFlareGameTools::FormatDate(RemainingDuration, 1));
+
+				if (PlayerCompany->IsTechnologyUnlocked("advanced-radar"))
+				{
+
+					TravelText = FText::Format(LOCTEXT("ThreatTextAdvancedFormat", "\u2022 <WarningText>{0} (Combat value of {1})</>\n    <WarningText>{3}</>\n    <WarningText>{2}</>"),
+							Company->GetCompanyName(),
+							EnemyValue,
+							GetShipsText(Entry.Value.LightShipCount, Entry.Value.HeavyShipCount),
+							TravelPartText);
+				}
+				else
+				{
+					TravelText = FText::Format(LOCTEXT("ThreatTextFormat", "\u2022 <WarningText>{0}</>\n    <WarningText>{2}</>\n    <WarningText>{1}</>"),
+
 						Company->GetCompanyName(),
-						EnemyValue,
-						GetShipsText(Entry.Value.LightShipCount, Entry.Value.HeavyShipCount),
+						GetUnknownShipText (Entry.Value.LightShipCount + Entry.Value.HeavyShipCount),
 						TravelPartText);
-			}
-			else
-			{
-				TravelText = FText::Format(LOCTEXT("ThreatTextFormat", "\u2022 <WarningText>{0}</>\n    <WarningText>{2}</>\n    <WarningText>{1}</>"),
+				}
 
-					Company->GetCompanyName(),
-					GetUnknownShipText (Entry.Value.LightShipCount + Entry.Value.HeavyShipCount),
-					TravelPartText);
+				// Add data
+				FFlareIncomingEvent TravelEvent;
+				TravelEvent.Text = TravelText;
+				TravelEvent.RemainingDuration = RemainingDuration;
+				IncomingThreatEvents.Add(TravelEvent);
 			}
-
-			// Add data
-			FFlareIncomingEvent TravelEvent;
-			TravelEvent.Text = TravelText;
-			TravelEvent.RemainingDuration = RemainingDuration;
-			IncomingEvents.Add(TravelEvent);
 		}
+
+		IncomingThreatEventsValid = true;
 	}
+	IncomingEvents.Append(IncomingThreatEvents);
 
 	// Warn of meteorites
 	for (UFlareSimulatedSector* Sector : GetSectors())
@@ -4,6 +4,7 @@
 #include "Object.h"
 #include "FlareGameTypes.h"
 #include "FlareTravel.h"
+#include "FlareWorldHelper.h"
 #include "Planetarium/FlareSimulatedPlanetarium.h"
 #include "FlareWorld.generated.h"
 
@@ -99,6 +100,14 @@ struct IncomingValue
 	int32 CombatValue = 0;
 };
 
+/** Registered shipyard, with its queue state cached for the current day */
+struct WorldShipyard
+{
+	UFlareSimulatedSpacecraft* Station = nullptr;
+	int64 EstimatedCompletionDate = 0;
+	int64 QueueStateDate = -1;
+};
+
 
 
 UCLASS()
@@ -171,6 +180,31 @@ public:
 	/** Add a factory to world */
 	void AddFactory(UFlareFactory* Factory);
 
+	/** Schedule a sleeping factory to be checked again on a given date */
+	void ScheduleFactoryWake(UFlareFactory* Factory, int64 Date);
+
+	/** Mark the incoming threat index as outdated, after a travel, war state or player fleet change */
+	void InvalidateIncomingPlayerEnemy();
+
+	/** Register a harpooned ship or a contested station for the daily capture processing */
+	void AddCaptureCandidate(UFlareSimulatedSpacecraft* Spacecraft);
+
+	void RemoveCaptureCandidate(UFlareSimulatedSpacecraft* Spacecraft);
+
+	/** Register or unregister a station in the shipyard registry, after a load, construction or upgrade */
+	void UpdateShipyard(UFlareSimulatedSpacecraft* Station);
+
+	void RemoveShipyard(UFlareSimulatedSpacecraft* Station);
+
+	/** Mark the cached queue state of a shipyard as outdated, after an order or a production change */
+	void InvalidateShipyardQueue(UFlareSimulatedSpacecraft* Station);
+
+	/** Get the shipyards in sectors known by a company and not owned by an enemy, least busy first */
+	void GetCompanyShipyards(UFlareCompany* Company, TArray<UFlareSimulatedSpacecraft*>& OutShipyards);
+
+	/** Mark the stock capacity of a sector as outdated, after a station is added, removed, built or upgraded */
+	void InvalidateSectorStockCapacity(UFlareSimulatedSector* Sector);
+
 protected:
 
 	/*----------------------------------------------------
@@ -192,12 +226,51 @@ protected:
 	UPROPERTY()
 	TArray<UFlareFactory*>                Factories;
 
+	/** Sleeping factories, by the date they must be checked again */
+	TMap<int64, TArray<UFlareFactory*>>   FactoryWakeQueue;
+
+	/** Daily economy recorder, while enabled in the game tools */
+	TSharedPtr<class FFlareEconomyRecorder> EconomyRecorder;
+
 	UPROPERTY()
 	TArray<UFlareTravel*>                Travels;
 
 	UPROPERTY()
 	UFlareSimulatedPlanetarium*			Planetarium;
 
+	/** Incoming enemy fleets heading to player sectors, rebuilt when invalidated */
+	TMap<IncomingKey, IncomingValue>      IncomingPlayerEnemyIndex;
+	TArray<FFlareIncomingEvent>           IncomingThreatEvents;
+	bool                                  IncomingPlayerEnemyIndexValid;
+	bool                                  IncomingThreatEventsValid;
+
+	/** Daily world resource stats snapshots, with and without storage hubs, computed when first needed */
+	TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats> WorldResourceStats;
+	TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats> WorldResourceStatsWithoutStorage;
+	bool                                  WorldResourceStatsValid;
+	bool                                  WorldResourceStatsWithoutStorageValid;
+
+	/** Daily construction score terms, by sector and factory */
+	TMap<UFlareSimulatedSector*, TMap<FFlareFactoryDescription*, WorldHelper::FlareFactoryScoreTerms>> FactoryScoreTerms;
+
+	/** Sector stock capacities shared by all companies, removed when a sector changes */
+	TMap<UFlareSimulatedSector*, WorldHelper::FlareSectorStockCapacity> SectorStockCapacities;
+
+	/** Rebuild the incoming threat index */
+	void UpdateIncomingPlayerEnemy();
+
+	/** Harpooned ships, and stations with capture points or capture orders */
+	TSet<UFlareSimulatedSpacecraft*>      ShipCaptureCandidates;
+	TSet<UFlareSimulatedSpacecraft*>      StationCaptureCandidates;
+
+	/** Group capture candidates by their current sector */
+	void GetCaptureCandidatesBySector(const TSet<UFlareSimulatedSpacecraft*>& Candidates, TMap<UFlareSimulatedSector*, TArray<UFlareSimulatedSpacecraft*>>& CandidatesBySector) const;
+
+	/** Shipyard registry */
+	TArray<WorldShipyard>                 Shipyards;
+
+	void UpdateShipyardQueue(WorldShipyard& Shipyard);
+
 	AFlareGame*                             Game;
 
 	bool WorldMoneyReferenceInit;
@@ -272,6 +345,18 @@ public:
 
 	int32 GetTotalWorldCombatPoint();
 
-	TMap<IncomingKey, IncomingValue> GetIncomingPlayerEnemy();
+	const TMap<IncomingKey, IncomingValue>& GetIncomingPlayerEnemy();
+
+	/** Get the world resource stats snapshot, taken once before the AI phase and once at the end of the day */
+	const TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats>& GetWorldResourceStats(bool IncludeStorage = true);
+
+	/** Drop the world resource stats snapshots, computed again on the next query */
+	void InvalidateWorldResourceStats();
+
+	/** Get the company-independent construction score terms of a factory in a sector, computed at most once per day */
+	const WorldHelper::FlareFactoryScoreTerms& GetFactoryScoreTerms(UFlareSimulatedSector* Sector, FFlareFactoryDescription* FactoryDescription);
+
+	/** Get the consumer and maintenance stock capacity of a sector, computed again only after a change */
+	const WorldHelper::FlareSectorStockCapacity& GetSectorStockCapacity(UFlareSimulatedSector* Sector);
 
 };
@@ -4,6 +4,7 @@
 
 #include "../Data/FlareResourceCatalog.h"
 
+#include "FlareCompany.h"
 #include "FlareGame.h"
 #include "FlareWorld.h"
 #include "FlareSectorHelper.h"
@@ -13,6 +14,8 @@
 #include "../Spacecrafts/FlareSimulatedSpacecraft.h"
 
 DECLARE_CYCLE_STAT(TEXT("WorldHelper ComputeWorldResourceStats"), STAT_WorldHelper_ComputeWorldResourceStats, STATGROUP_Flare);
+DECLARE_CYCLE_STAT(TEXT("WorldHelper ComputeFactoryScoreTerms"), STAT_WorldHelper_ComputeFactoryScoreTerms, STATGROUP_Flare);
+DECLARE_CYCLE_STAT(TEXT("WorldHelper ComputeSectorStockCapacity"), STAT_WorldHelper_ComputeSectorStockCapacity, STATGROUP_Flare);
 
 
 TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats> WorldHelper::ComputeWorldResourceStats(AFlareGame* Game, bool IncludeStorage)
@@ -80,3 +83,124 @@ TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats> WorldHelper::C
 
 	return WorldStats;
 }
+
+WorldHelper::FlareFactoryScoreTerms WorldHelper::ComputeFactoryScoreTerms(UFlareSimulatedSector* Sector, FFlareFactoryDescription* FactoryDescription, const TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats>& WorldStats)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WorldHelper_ComputeFactoryScoreTerms);
+
+	WorldHelper::FlareFactoryScoreTerms Terms;
+	Terms.InputAvailable = true;
+	Terms.InputUnderflowMalus = 1.f;
+	Terms.InputPriceScore = 1.f;
+	Terms.GainPerCycle = -(float) FactoryDescription->CycleCost.ProductionCost;
+
+	// Inputs
+	for (int32 ResourceIndex = 0; ResourceIndex < FactoryDescription->CycleCost.InputResources.Num(); ResourceIndex++)
+	{
+		const FFlareFactoryResource* Resource = &FactoryDescription->CycleCost.InputResources[ResourceIndex];
+		FFlareResourceDescription* ResourceDescription = &Resource->Resource->Data;
+		const WorldHelper::FlareResourceStats& ResourceStats = WorldStats[ResourceDescription];
+
+		Terms.GainPerCycle -= Sector->GetResourcePrice(ResourceDescription, EFlareResourcePriceContext::FactoryInput) * Resource->Quantity;
+
+		float MaxVolume = FMath::Max(ResourceStats.Production, ResourceStats.Consumption);
+		if (MaxVolume > 0)
+		{
+			float UnderflowRatio = ResourceStats.Balance / MaxVolume;
+			if (UnderflowRatio < 0)
+			{
+				Terms.InputUnderflowMalus *= FMath::Clamp((UnderflowRatio * 100)  / 20.f + 1.f, 0.f, 1.f);
+			}
+		}
+		else
+		{
+			// No input production
+			Terms.InputAvailable = false;
+		}
+
+		float ResourcePrice = Sector->GetPreciseResourcePrice(ResourceDescription);
+		float PriceRatio = (ResourcePrice - (float) ResourceDescription->MinPrice) / (float) (ResourceDescription->MaxPrice - ResourceDescription->MinPrice);
+		Terms.InputPriceScore *= (1 - PriceRatio) * 2;
+	}
+
+	// Outputs
+	for (int32 ResourceIndex = 0; ResourceIndex < FactoryDescription->CycleCost.OutputResources.Num(); ResourceIndex++)
+	{
+		const FFlareFactoryResource* Resource = &FactoryDescription->CycleCost.OutputResources[ResourceIndex];
+		FFlareResourceDescription* ResourceDescription = &Resource->Resource->Data;
+		const WorldHelper::FlareResourceStats& ResourceStats = WorldStats[ResourceDescription];
+
+		Terms.GainPerCycle += Sector->GetResourcePrice(ResourceDescription, EFlareResourcePriceContext::FactoryOutput) * Resource->Quantity;
+
+		float MaxVolume = FMath::Max(ResourceStats.Production, ResourceStats.Consumption);
+		Terms.OutputHasVolume.Add(MaxVolume > 0);
+		Terms.OutputOverflowRatio.Add(MaxVolume > 0 ? ResourceStats.Balance / MaxVolume : 0.f);
+
+		float ResourcePrice = Sector->GetPreciseResourcePrice(ResourceDescription);
+		float PriceRatio = (ResourcePrice - (float) ResourceDescription->MinPrice) / (float) (ResourceDescription->MaxPrice - ResourceDescription->MinPrice);
+		Terms.OutputPriceScore.Add(PriceRatio * 2);
+	}
+
+	return Terms;
+}
+
+WorldHelper::FlareSectorStockCapacity WorldHelper::ComputeSectorStockCapacity(UFlareSimulatedSector* Sector)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WorldHelper_ComputeSectorStockCapacity);
+
+	// Same rules as AITradeHelper::ComputeSectorResourceVariation, without the company-dependent flows
+	FlareSectorStockCapacity StockCapacity;
+
+	for (UFlareSimulatedSpacecraft* Station : Sector->GetSectorStations())
+	{
+		if (Station->IsUnderConstruction())
+		{
+			continue;
+		}
+
+		int32 SlotCapacity = Station->GetActiveCargoBay()->GetSlotCapacity();
+
+		if (Station->HasCapability(EFlareSpacecraftCapability::Consumer))
+		{
+			StockCapacity.ConsumerMaxStock.FindOrAdd(Station->GetCompany()) += SlotCapacity;
+		}
+
+		if (Station->HasCapability(EFlareSpacecraftCapability::Maintenance))
+		{
+			StockCapacity.MaintenanceMaxStock.FindOrAdd(Station->GetCompany()) += SlotCapacity;
+		}
+
+		if (Station->HasCapability(EFlareSpacecraftCapability::Storage))
+		{
+			StockCapacity.MaintenanceMaxStock.FindOrAdd(Station->GetCompany()) += SlotCapacity;
+		}
+	}
+
+	return StockCapacity;
+}
+
+int32 WorldHelper::FlareSectorStockCapacity::GetConsumerMaxStock(UFlareCompany* Company) const
+{
+	int32 MaxStock = 0;
+	for (auto& Entry : ConsumerMaxStock)
+	{
+		if (Entry.Key->GetWarState(Company) != EFlareHostility::Hostile)
+		{
+			MaxStock += Entry.Value;
+		}
+	}
+	return MaxStock;
+}
+
+int32 WorldHelper::FlareSectorStockCapacity::GetMaintenanceMaxStock(UFlareCompany* Company) const
+{
+	int32 MaxStock = 0;
+	for (auto& Entry : MaintenanceMaxStock)
+	{
+		if (Entry.Key->GetWarState(Company) != EFlareHostility::Hostile)
+		{
+			MaxStock += Entry.Value;
+		}
+	}
+	return MaxStock;
+}
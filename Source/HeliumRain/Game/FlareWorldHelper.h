@@ -1,6 +1,10 @@
 #pragma once
 #include "../Economy/FlareResource.h"
-#include "FlareWorld.h"
+
+class AFlareGame;
+class UFlareCompany;
+class UFlareSimulatedSector;
+struct FFlareFactoryDescription;
 
 struct WorldHelper
 {
@@ -13,8 +17,44 @@ struct WorldHelper
 		int32 Capacity;
 	};
 
+	/** Company-independent part of the construction score of a factory in a sector */
+	struct FlareFactoryScoreTerms
+	{
+		/** False if an input resource is not produced anywhere */
+		bool InputAvailable;
+
+		/** Product of the input underflow maluses */
+		float InputUnderflowMalus;
+
+		/** Product of the input price terms */
+		float InputPriceScore;
+
+		/** Output overflow ratio and price term, per output resource. Overflow is only set if the output is traded */
+		TArray<bool> OutputHasVolume;
+		TArray<float> OutputOverflowRatio;
+		TArray<float> OutputPriceScore;
+
+		/** Gain per cycle at the sector prices */
+		float GainPerCycle;
+	};
+
+	/** Company-independent part of a sector resource variation : consumer and maintenance stock capacity, by station owner */
+	struct FlareSectorStockCapacity
+	{
+		TMap<UFlareCompany*, int32> ConsumerMaxStock;
+		TMap<UFlareCompany*, int32> MaintenanceMaxStock;
+
+		/** Company overlay : stations of hostile companies are ignored */
+		int32 GetConsumerMaxStock(UFlareCompany* Company) const;
+		int32 GetMaintenanceMaxStock(UFlareCompany* Company) const;
+	};
+
 	static TMap<FFlareResourceDescription*, FlareResourceStats> ComputeWorldResourceStats(AFlareGame* Game, bool IncludeStorage);
 
+	static FlareFactoryScoreTerms ComputeFactoryScoreTerms(UFlareSimulatedSector* Sector, FFlareFactoryDescription* FactoryDescription, const TMap<FFlareResourceDescription*, FlareResourceStats>& WorldStats);
+
+	static FlareSectorStockCapacity ComputeSectorStockCapacity(UFlareSimulatedSector* Sector);
+
 
 private:
 
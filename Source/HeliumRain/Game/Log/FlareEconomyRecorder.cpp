@@ -0,0 +1,384 @@
+
+#include "FlareEconomyRecorder.h"
+#include "../../Flare.h"
+
+#include "../../Data/FlareResourceCatalog.h"
+
+#include "../FlareGame.h"
+#include "../FlareWorld.h"
+#include "../FlareCompany.h"
+#include "../FlareSimulatedSector.h"
+#include "../FlareSectorHelper.h"
+
+
+#define ECONOMY_RECORD_SCHEMA_BLOCK 'S'
+#define ECONOMY_RECORD_DAY_BLOCK    'D'
+#define ECONOMY_RECORD_VERSION      1
+
+
+/*----------------------------------------------------
+	Encoding
+----------------------------------------------------*/
+
+static void WriteVarint(TArray<uint8>& Buffer, uint64 Value)
+{
+	while (Value >= 0x80)
+	{
+		Buffer.Add((uint8) (Value | 0x80));
+		Value >>= 7;
+	}
+	Buffer.Add((uint8) Value);
+}
+
+static void WriteSigned(TArray<uint8>& Buffer, int64 Value)
+{
+	// Zigzag, so that small negative deltas stay short
+	WriteVarint(Buffer, ((uint64) Value << 1) ^ (uint64) (Value >> 63));
+}
+
+static void WriteName(TArray<uint8>& Buffer, FName Name)
+{
+	FTCHARToUTF8 Converted(*Name.ToString());
+	WriteVarint(Buffer, Converted.Length());
+	Buffer.Append((const uint8*) Converted.Get(), Converted.Length());
+}
+
+static void WriteColumn(TArray<uint8>& Buffer, const TArray<int64>& Values, const TArray<int64>* PreviousValues)
+{
+	for (int32 Index = 0; Index < Values.Num(); Index++)
+	{
+		WriteSigned(Buffer, Values[Index] - (PreviousValues ? (*PreviousValues)[Index] : 0));
+	}
+}
+
+static bool ReadVarint(const TArray<uint8>& Data, int32& Offset, uint64& OutValue)
+{
+	OutValue = 0;
+
+	for (int32 Shift = 0; Shift < 64; Shift += 7)
+	{
+		if (Offset >= Data.Num())
+		{
+			return false;
+		}
+
+		uint8 Byte = Data[Offset++];
+		OutValue |= (uint64) (Byte & 0x7F) << Shift;
+
+		if (!(Byte & 0x80))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool ReadSigned(const TArray<uint8>& Data, int32& Offset, int64& OutValue)
+{
+	uint64 Encoded;
+	if (!ReadVarint(Data, Offset, Encoded))
+	{
+		return false;
+	}
+
+	OutValue = (int64) (Encoded >> 1) ^ -(int64) (Encoded & 1);
+	return true;
+}
+
+static bool ReadName(const TArray<uint8>& Data, int32& Offset, FName& OutName)
+{
+	// Compare against the remaining bytes, a corrupted length could overflow the end offset
+	uint64 Length;
+	if (!ReadVarint(Data, Offset, Length) || Length > (uint64) (Data.Num() - Offset))
+	{
+		return false;
+	}
+
+	int32 NameLength = (int32) Length;
+	TArray<ANSICHAR> Characters;
+	Characters.Append((const ANSICHAR*) (Data.GetData() + Offset), NameLength);
+	Characters.Add('\0');
+	Offset += NameLength;
+
+	OutName = FName(UTF8_TO_TCHAR(Characters.GetData()));
+	return true;
+}
+
+static bool ReadColumn(const TArray<uint8>& Data, int32& Offset, int64 Count, const TArray<int64>* PreviousValues, TArray<int64>& OutValues)
+{
+	// Each value takes at least one byte
+	if (Count > Data.Num() - Offset)
+	{
+		return false;
+	}
+
+	OutValues.SetNumUninitialized((int32) Count);
+
+	for (int32 Index = 0; Index < Count; Index++)
+	{
+		int64 Delta;
+		if (!ReadSigned(Data, Offset, Delta))
+		{
+			return false;
+		}
+
+		OutValues[Index] = Delta + (PreviousValues ? (*PreviousValues)[Index] : 0);
+	}
+
+	return true;
+}
+
+
+/*----------------------------------------------------
+	Recorder
+----------------------------------------------------*/
+
+FFlareEconomyRecorder::FFlareEconomyRecorder(FName UUID)
+	: HasPreviousRecord(false)
+{
+	FString FileName = GetRecordPath(UUID);
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	FLOGV("Init economy record file '%s'", *FileName);
+	File = PlatformFile.OpenWrite(*FileName, true);
+
+	if (!File)
+	{
+		FLOGV("Fail to init economy record file '%s'", *FileName);
+	}
+}
+
+FFlareEconomyRecorder::~FFlareEconomyRecorder()
+{
+	if (File)
+	{
+		delete File;
+		File = NULL;
+	}
+}
+
+FString FFlareEconomyRecorder::GetRecordPath(FName UUID)
+{
+	return FString::Printf(TEXT("%s/SaveGames/Economy-%s.rec"), *FPaths::ProjectSavedDir(), *UUID.ToString());
+}
+
+void FFlareEconomyRecorder::RecordDay(UFlareWorld* World)
+{
+	if (!File)
+	{
+		return;
+	}
+
+	// Start a new delta sequence on the first day or after a schema change
+	if (UpdateSchema(World))
+	{
+		WriteSchema();
+		HasPreviousRecord = false;
+	}
+
+	UFlareResourceCatalog* ResourceCatalog = World->GetGame()->GetResourceCatalog();
+
+	FlareEconomyRecord Record;
+	Record.Date = World->GetDate();
+
+	for (UFlareSimulatedSector* Sector : World->GetSectors())
+	{
+		TMap<FFlareResourceDescription*, WorldHelper::FlareResourceStats> Stats = SectorHelper::ComputeSectorResourceStats(Sector, true);
+
+		for (UFlareResourceCatalogEntry* Entry : ResourceCatalog->Resources)
+		{
+			FFlareResourceDescription* Resource = &Entry->Data;
+			const WorldHelper::FlareResourceStats& ResourceStats = Stats[Resource];
+
+			Record.Prices.Add(Sector->GetResourcePrice(Resource, EFlareResourcePriceContext::Default));
+			Record.Stocks.Add(ResourceStats.Stock);
+			Record.Productions.Add(FMath::RoundToInt(ResourceStats.Production * 1000));
+			Record.Consumptions.Add(FMath::RoundToInt(ResourceStats.Consumption * 1000));
+		}
+	}
+
+	for (UFlareCompany* Company : World->GetCompanies())
+	{
+		Record.Money.Add(Company->GetMoney());
+		Record.Values.Add(Company->GetCompanyValue().TotalValue);
+		Record.FleetSizes.Add(Company->GetCompanyShips().Num());
+	}
+
+	WriteRecord(Record);
+
+	PreviousRecord = Record;
+	HasPreviousRecord = true;
+}
+
+bool FFlareEconomyRecorder::UpdateSchema(UFlareWorld* World)
+{
+	FlareEconomySchema NewSchema;
+
+	for (UFlareSimulatedSector* Sector : World->GetSectors())
+	{
+		NewSchema.Sectors.Add(Sector->GetIdentifier());
+	}
+
+	for (UFlareResourceCatalogEntry* Entry : World->GetGame()->GetResourceCatalog()->Resources)
+	{
+		NewSchema.Resources.Add(Entry->Data.Identifier);
+	}
+
+	for (UFlareCompany* Company : World->GetCompanies())
+	{
+		NewSchema.Companies.Add(Company->GetIdentifier());
+	}
+
+	if (HasPreviousRecord
+		&& NewSchema.Sectors == Schema.Sectors
+		&& NewSchema.Resources == Schema.Resources
+		&& NewSchema.Companies == Schema.Companies)
+	{
+		return false;
+	}
+
+	Schema = NewSchema;
+	return true;
+}
+
+void FFlareEconomyRecorder::WriteSchema()
+{
+	Buffer.Reset();
+	Buffer.Add(ECONOMY_RECORD_SCHEMA_BLOCK);
+	WriteVarint(Buffer, ECONOMY_RECORD_VERSION);
+
+	for (const TArray<FName>* Names : { &Schema.Sectors, &Schema.Resources, &Schema.Companies })
+	{
+		WriteVarint(Buffer, Names->Num());
+		for (FName Name : *Names)
+		{
+			WriteName(Buffer, Name);
+		}
+	}
+
+	File->Write(Buffer.GetData(), Buffer.Num());
+}
+
+void FFlareEconomyRecorder::WriteRecord(const FlareEconomyRecord& Record)
+{
+	const FlareEconomyRecord* Previous = HasPreviousRecord ? &PreviousRecord : NULL;
+
+	Buffer.Reset();
+	Buffer.Add(ECONOMY_RECORD_DAY_BLOCK);
+	WriteSigned(Buffer, Record.Date - (Previous ? Previous->Date : 0));
+
+	WriteColumn(Buffer, Record.Prices, Previous ? &Previous->Prices : NULL);
+	WriteColumn(Buffer, Record.Stocks, Previous ? &Previous->Stocks : NULL);
+	WriteColumn(Buffer, Record.Productions, Previous ? &Previous->Productions : NULL);
+	WriteColumn(Buffer, Record.Consumptions, Previous ? &Previous->Consumptions : NULL);
+	WriteColumn(Buffer, Record.Money, Previous ? &Previous->Money : NULL);
+	WriteColumn(Buffer, Record.Values, Previous ? &Previous->Values : NULL);
+	WriteColumn(Buffer, Record.FleetSizes, Previous ? &Previous->FleetSizes : NULL);
+
+	File->Write(Buffer.GetData(), Buffer.Num());
+}
+
+
+/*----------------------------------------------------
+	Reader
+----------------------------------------------------*/
+
+bool FFlareEconomyRecordReader::Open(const FString& Path)
+{
+	Data.Empty();
+	Offset = 0;
+	HasPreviousRecord = false;
+
+	if (!FFileHelper::LoadFileToArray(Data, *Path))
+	{
+		FLOGV("FFlareEconomyRecordReader::Open : can't read '%s'", *Path);
+		return false;
+	}
+
+	return true;
+}
+
+bool FFlareEconomyRecordReader::ReadNext(FlareEconomyRecord& OutRecord)
+{
+	while (Offset < Data.Num())
+	{
+		uint8 Block = Data[Offset++];
+
+		if (Block == ECONOMY_RECORD_SCHEMA_BLOCK)
+		{
+			if (!ReadSchema())
+			{
+				FLOG("FFlareEconomyRecordReader::ReadNext : corrupted schema");
+				return false;
+			}
+
+			HasPreviousRecord = false;
+			continue;
+		}
+		else if (Block != ECONOMY_RECORD_DAY_BLOCK)
+		{
+			FLOGV("FFlareEconomyRecordReader::ReadNext : unknown block %d", Block);
+			return false;
+		}
+
+		const FlareEconomyRecord* Previous = HasPreviousRecord ? &PreviousRecord : NULL;
+		int64 SectorResourceCount = (int64) Schema.Sectors.Num() * Schema.Resources.Num();
+		int32 CompanyCount = Schema.Companies.Num();
+
+		int64 DateDelta;
+		if (!ReadSigned(Data, Offset, DateDelta)
+			|| !ReadColumn(Data, Offset, SectorResourceCount, Previous ? &Previous->Prices : NULL, OutRecord.Prices)
+			|| !ReadColumn(Data, Offset, SectorResourceCount, Previous ? &Previous->Stocks : NULL, OutRecord.Stocks)
+			|| !ReadColumn(Data, Offset, SectorResourceCount, Previous ? &Previous->Productions : NULL, OutRecord.Productions)
+			|| !ReadColumn(Data, Offset, SectorResourceCount, Previous ? &Previous->Consumptions : NULL, OutRecord.Consumptions)
+			|| !ReadColumn(Data, Offset, CompanyCount, Previous ? &Previous->Money : NULL, OutRecord.Money)
+			|| !ReadColumn(Data, Offset, CompanyCount, Previous ? &Previous->Values : NULL, OutRecord.Values)
+			|| !ReadColumn(Data, Offset, CompanyCount, Previous ? &Previous->FleetSizes : NULL, OutRecord.FleetSizes))
+		{
+			FLOG("FFlareEconomyRecordReader::ReadNext : truncated day");
+			return false;
+		}
+
+		OutRecord.Date = DateDelta + (Previous ? Previous->Date : 0);
+
+		PreviousRecord = OutRecord;
+		HasPreviousRecord = true;
+		return true;
+	}
+
+	return false;
+}
+
+bool FFlareEconomyRecordReader::ReadSchema()
+{
+	uint64 Version;
+	if (!ReadVarint(Data, Offset, Version) || Version != ECONOMY_RECORD_VERSION)
+	{
+		return false;
+	}
+
+	for (TArray<FName>* Names : { &Schema.Sectors, &Schema.Resources, &Schema.Companies })
+	{
+		// Each name takes at least one byte
+		uint64 Count;
+		if (!ReadVarint(Data, Offset, Count) || Count > (uint64) (Data.Num() - Offset))
+		{
+			return false;
+		}
+
+		int32 NameCount = (int32) Count;
+		Names->Empty(NameCount);
+		for (int32 Index = 0; Index < NameCount; Index++)
+		{
+			FName Name;
+			if (!ReadName(Data, Offset, Name))
+			{
+				return false;
+			}
+			Names->Add(Name);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "../../Flare.h"
+
+class UFlareWorld;
+
+
+/** Identifiers of the recorded sectors, resources and companies, in record order */
+struct FlareEconomySchema
+{
+	TArray<FName> Sectors;
+	TArray<FName> Resources;
+	TArray<FName> Companies;
+};
+
+/** Economy state at the end of a day */
+struct FlareEconomyRecord
+{
+	int64 Date;
+
+	/** Per sector and resource, sector-major. Production and consumption are in thousandths of units per day */
+	TArray<int64> Prices;
+	TArray<int64> Stocks;
+	TArray<int64> Productions;
+	TArray<int64> Consumptions;
+
+	/** Per company */
+	TArray<int64> Money;
+	TArray<int64> Values;
+	TArray<int64> FleetSizes;
+};
+
+
+/**
+ * Opt-in daily economy time series, written next to the game logs.
+ *
+ * The file is a sequence of blocks. A schema block lists the identifiers and resets the delta state,
+ * a day block stores each column in turn as zigzag varints, delta-encoded against the previous day.
+ */
+class FFlareEconomyRecorder
+{
+public:
+
+	FFlareEconomyRecorder(FName UUID);
+
+	~FFlareEconomyRecorder();
+
+	/** Append the state of the world at the end of the day */
+	void RecordDay(UFlareWorld* World);
+
+	/** Get the record file of a game */
+	static FString GetRecordPath(FName UUID);
+
+protected:
+
+	/** Rebuild the schema from the world, return true if it changed */
+	bool UpdateSchema(UFlareWorld* World);
+
+	void WriteSchema();
+
+	void WriteRecord(const FlareEconomyRecord& Record);
+
+	IFileHandle*                 File;
+	FlareEconomySchema           Schema;
+	FlareEconomyRecord           PreviousRecord;
+	bool                         HasPreviousRecord;
+	TArray<uint8>                Buffer;
+};
+
+
+/** Sequential reader for economy record files */
+class FFlareEconomyRecordReader
+{
+public:
+
+	FFlareEconomyRecordReader()
+		: Offset(0)
+		, HasPreviousRecord(false)
+	{}
+
+	/** Load a record file, return false if it can't be read */
+	bool Open(const FString& Path);
+
+	/** Decode the next day, return false at the end of the file or on corrupted data */
+	bool ReadNext(FlareEconomyRecord& OutRecord);
+
+	/** Get the schema of the last record read */
+	inline const FlareEconomySchema& GetSchema() const
+	{
+		return Schema;
+	}
+
+protected:
+
+	bool ReadSchema();
+
+	TArray<uint8>                Data;
+	int32                        Offset;
+	FlareEconomySchema           Schema;
+	FlareEconomyRecord           PreviousRecord;
+	bool                         HasPreviousRecord;
+};
@@ -50,6 +50,7 @@ void UFlareSimulatedSpacecraft::Load(const FFlareSpacecraftSave& Data)
 	SpacecraftData = Data;
 
 	ComplexChildren.Empty();
+	InvalidateShipyardTimeline();
 
 	// Load spacecraft description
 	SpacecraftDescription = Game->GetSpacecraftCatalog()->Get(Data.Identifier);
@@ -270,6 +271,29 @@ void UFlareSimulatedSpacecraft::Load(const FFlareSpacecraftSave& Data)
 		ActiveSpacecraft->Load(this);
 		ActiveSpacecraft->Redock();
 	}
+
+	Company->InvalidateSpacecraftValue(this);
+
+	if (GetCurrentSector())
+	{
+		GetCurrentSector()->InvalidateResourceStats();
+	}
+
+	if ((IsHarpooned() || IsBeingCaptured()) && Game->GetGameWorld())
+	{
+		Game->GetGameWorld()->AddCaptureCandidate(this);
+	}
+
+	if (IsStation() && Game->GetGameWorld())
+	{
+		Game->GetGameWorld()->UpdateShipyard(this);
+
+		if (GetCurrentSector())
+		{
+			Game->GetGameWorld()->InvalidateSectorStockCapacity(GetCurrentSector());
+			GetCurrentSector()->GetPeople()->InvalidateConsumerMarket();
+		}
+	}
 }
 
 void UFlareSimulatedSpacecraft::Reload()
@@ -406,6 +430,13 @@ bool UFlareSimulatedSpacecraft::CanBeFlown(FText& OutInfo) const
 void UFlareSimulatedSpacecraft::SetCurrentSector(UFlareSimulatedSector* Sector)
 {
 	CurrentSector = Sector;
+	GetCompany()->InvalidateSpacecraftValue(this);
+
+	// Player ships moving change which sectors enemies may threaten
+	if (GetCompany()->IsPlayerCompany() && GetGame()->GetGameWorld())
+	{
+		GetGame()->GetGameWorld()->InvalidateIncomingPlayerEnemy();
+	}
 
 	// Mark the sector as visited
 	if (!Sector->IsTravelSector())
@@ -1100,6 +1131,7 @@ void UFlareSimulatedSpacecraft::SetHarpooned(UFlareCompany* OwnerCompany)
 		{
 			CombatLog::SpacecraftHarpooned(this, OwnerCompany);
 			SpacecraftData.HarpoonCompany  = OwnerCompany->GetIdentifier();
+			Game->GetGameWorld()->AddCaptureCandidate(this);
 		}
 	}
 	else
@@ -1689,6 +1721,8 @@ UFlareFactory* UFlareSimulatedSpacecraft::GetCompatibleIdleShipyardFactory(FName
 
 void UFlareSimulatedSpacecraft::UpdateShipyardProduction()
 {
+	InvalidateShipyardTimeline();
+
 	if(IsComplexElement())
 	{
 		GetComplexMaster()->UpdateShipyardProduction();
@@ -1743,6 +1777,8 @@ void UFlareSimulatedSpacecraft::UpdateShipyardProduction()
 	{
 		SpacecraftData.ShipyardOrderQueue.RemoveAt(IndexToRemove[i]);
 	}
+
+	Game->GetGameWorld()->InvalidateShipyardQueue(this);
 }
 
 bool UFlareSimulatedSpacecraft::CanOrder(const FFlareSpacecraftDescription* ShipDescription, UFlareCompany* OrderCompany)
@@ -1846,16 +1882,47 @@ int32 UFlareSimulatedSpacecraft::GetEstimatedQueueAndProductionDuration(FName Sh
 		return 0;
 	}
 
+	// Remaining production durations move every day
+	int64 Date = Game->GetGameWorld()->GetDate();
+	if (ShipyardTimelineDate != Date)
+	{
+		UpdateShipyardTimeline(EFlarePartSize::S, ShipyardTimeline[0]);
+		UpdateShipyardTimeline(EFlarePartSize::L, ShipyardTimeline[1]);
+		ShipyardTimelineDate = Date;
+	}
+
 	FFlareSpacecraftDescription* Desc = GetGame()->GetSpacecraftCatalog()->Get(ShipIdentifier);
+	const TArray<int32>& Timeline = ShipyardTimeline[Desc->Size == EFlarePartSize::L ? 1 : 0];
 
-	int32 Duration = 0;
+	if(Timeline.Num() == 0)
+	{
+		FLOG("WARNING: no shipyard simulator");
+		return 0;
+	}
+
+	if(OrderIndex < 0)
+	{
+		OrderIndex = SpacecraftData.ShipyardOrderQueue.Num();
+	}
+
+	return Timeline[OrderIndex];
+}
+
+void UFlareSimulatedSpacecraft::InvalidateShipyardTimeline()
+{
+	ShipyardTimelineDate = -1;
+}
+
+void UFlareSimulatedSpacecraft::UpdateShipyardTimeline(EFlarePartSize::Type Size, TArray<int32>& OutTimeline)
+{
+	OutTimeline.Reset();
 
 	TArray<int32> ShipyardSimulators;
 
 	for (UFlareFactory* Factory : Factories)
 	{
-		if((Factory->IsSmallShipyard() && Desc->Size == EFlarePartSize::S) ||
-			(Factory->IsLargeShipyard() && Desc->Size == EFlarePartSize::L))
+		if((Factory->IsSmallShipyard() && Size == EFlarePartSize::S) ||
+			(Factory->IsLargeShipyard() && Size == EFlarePartSize::L))
 		{
 			if(Factory->IsActive())
 			{
@@ -1870,16 +1937,12 @@ int32 UFlareSimulatedSpacecraft::GetEstimatedQueueAndProductionDuration(FName Sh
 
 	if(ShipyardSimulators.Num() == 0)
 	{
-		FLOG("WARNING: no shipyard simulator");
-		return 0;
-	}
-
-	if(OrderIndex < 0)
-	{
-		OrderIndex = SpacecraftData.ShipyardOrderQueue.Num();
+		return;
 	}
 
-	int32 NextOrderIndex = 0;
+	// Each order starts on the first free factory, a new order would start after the whole queue
+	int32 OrderCount = SpacecraftData.ShipyardOrderQueue.Num();
+	int32 Duration = 0;
 
 	while(true)
 	{
@@ -1902,17 +1965,14 @@ int32 UFlareSimulatedSpacecraft::GetEstimatedQueueAndProductionDuration(FName Sh
 
 			if (ProductionDuration <= 0)
 			{
-				// Try to queue
-				if(NextOrderIndex == OrderIndex)
+				int32 NextOrderIndex = OutTimeline.Add(Duration);
+				if(NextOrderIndex == OrderCount)
 				{
-					// Enqueue the target, return duration
-					return  Duration;
+					return;
 				}
 
 				FFlareShipyardOrderSave& Order = SpacecraftData.ShipyardOrderQueue[NextOrderIndex];
-				int32 ShipProductionDuration = GetShipProductionTime(Order.ShipClass);
-				ProductionDuration = ShipProductionDuration;
-				NextOrderIndex++;
+				ProductionDuration = GetShipProductionTime(Order.ShipClass);
 			}
 		}
 	}
@@ -228,8 +228,12 @@ public:
 
 	int32 GetShipProductionTime(FName ShipIdentifier);
 
+	/** Get the delay before an order starts, or before a new order would start if OrderIndex is negative */
 	int32 GetEstimatedQueueAndProductionDuration(FName ShipIdentifier, int32 OrderIndex);
 
+	/** Mark the order timeline as outdated, after a queue or production change */
+	void InvalidateShipyardTimeline();
+
 	bool IsShipyardMissingResources();
 
 	FText GetShipCost(FName ShipIdentifier);
@@ -249,6 +253,9 @@ protected:
 
 	void RemoveCapturePoint(FName CompanyIdentifier, int32 CapturePoint);
 
+	/** Simulate the shipyard factories of a ship size to find the start delay of each order */
+	void UpdateShipyardTimeline(EFlarePartSize::Type Size, TArray<int32>& OutTimeline);
+
     /*----------------------------------------------------
         Protected data
     ----------------------------------------------------*/
@@ -285,6 +292,10 @@ protected:
 	UFlareSimulatedSpacecraft*								ComplexMaster;
 	TArray<UFlareSimulatedSpacecraft*>						ComplexChildren;
 
+	// Start delay of each queued order then of a new order, for small and large ships, valid for one day
+	TArray<int32>                                           ShipyardTimeline[2];
+	int64                                                   ShipyardTimelineDate;
+
 public:
 
     /*----------------------------------------------------
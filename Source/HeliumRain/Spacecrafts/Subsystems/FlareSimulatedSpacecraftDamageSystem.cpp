@@ -282,7 +282,7 @@ float UFlareSimulatedSpacecraftDamageSystem::Repair(FFlareSpacecraftComponentDes
 
 		//FLOGV("%s %s repair %f for %f fs (damage ratio: %f)",  *Spacecraft->GetImmatriculation().ToString(),  *ComponentData->ShipSlotIdentifier.ToString(), RepairRatio, RepairCost, GetDamageRatio(ComponentDescription, ComponentData));
 
-		Spacecraft->GetCompany()->InvalidateCompanyValueCache();
+		Spacecraft->GetCompany()->InvalidateSpacecraftValue(Spacecraft);
 
 		if (Spacecraft->IsActive())
 		{
@@ -340,7 +340,7 @@ float UFlareSimulatedSpacecraftDamageSystem::Refill(FFlareSpacecraftComponentDes
 		FLOGV("NewAmmoCount %d,",NewAmmoCount);
 		FLOGV("ComponentData->Weapon.FiredAmmo %d,",ComponentData->Weapon.FiredAmmo);
 */
-		Spacecraft->GetCompany()->InvalidateCompanyValueCache();
+		Spacecraft->GetCompany()->InvalidateSpacecraftValue(Spacecraft);
 
 		if (Spacecraft->IsActive())
 		{
@@ -466,7 +466,7 @@ float UFlareSimulatedSpacecraftDamageSystem::ApplyDamage(FFlareSpacecraftCompone
 			}
 		}
 
-		Spacecraft->GetCompany()->InvalidateCompanyValueCache();
+		Spacecraft->GetCompany()->InvalidateSpacecraftValue(Spacecraft);
 	}
 
 	LastDamageCause = DamageCause(DamageSource, DamageType);
@@ -348,7 +348,7 @@ void SFlareWorldEconomyMenu::Enter(FFlareResourceDescription* Resource, UFlareSi
 	{
 		TargetResource = Resource;
 	}
-	WorldStats = WorldHelper::ComputeWorldResourceStats(MenuManager->GetGame(), IncludeTradingHubsButton->IsActive());
+	WorldStats = MenuManager->GetGame()->GetGameWorld()->GetWorldResourceStats(IncludeTradingHubsButton->IsActive());
 
 	// Default state
 	IsCurrentSortDescending = false;
@@ -904,7 +904,7 @@ void SFlareWorldEconomyMenu::OnOpenSectorPrices(UFlareSimulatedSector* Sector)
 void SFlareWorldEconomyMenu::OnIncludeTradingHubsToggle()
 {
 	GenerateSectorList();
-	WorldStats = WorldHelper::ComputeWorldResourceStats(MenuManager->GetGame(), IncludeTradingHubsButton->IsActive());
+	WorldStats = MenuManager->GetGame()->GetGameWorld()->GetWorldResourceStats(IncludeTradingHubsButton->IsActive());
 }
 
 #undef LOCTEXT_NAMESPACE